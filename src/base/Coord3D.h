@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_COORD3D_H
+#define __INET_COORD3D_H
+
+#include <math.h>
+#include <iostream>
+#include "INETDefs.h"
+#include "Coord.h"
+
+/**
+ * @brief Plain three-dimensional position / vector.
+ *
+ * Unlike Coord, this is not a cPolymorphic: it has no vtable pointer, so
+ * it is 24 bytes, can be copied with memcpy, and arrays of it are densely
+ * packed. Use it in distance-heavy code; Coord remains the type of the
+ * host positions passed around via NotificationBoard and ChannelControl.
+ *
+ * Prefer sqrdist() to distance() when only comparing distances.
+ *
+ * @ingroup support
+ */
+class INET_API Coord3D
+{
+  public:
+    double x, y, z;
+
+  public:
+    Coord3D() : x(0), y(0), z(0) {}
+    Coord3D(double x, double y, double z=0) : x(x), y(y), z(z) {}
+
+    /** Converts a 2D position; z will be 0. */
+    explicit Coord3D(const Coord& c) : x(c.x), y(c.y), z(0) {}
+
+    /** Returns the x and y coordinates as Coord. */
+    Coord toCoord() const {return Coord(x, y);}
+
+    friend Coord3D operator+(const Coord3D& a, const Coord3D& b) {return Coord3D(a.x+b.x, a.y+b.y, a.z+b.z);}
+    friend Coord3D operator-(const Coord3D& a, const Coord3D& b) {return Coord3D(a.x-b.x, a.y-b.y, a.z-b.z);}
+    friend Coord3D operator*(const Coord3D& a, double f) {return Coord3D(a.x*f, a.y*f, a.z*f);}
+    friend Coord3D operator/(const Coord3D& a, double f) {return Coord3D(a.x/f, a.y/f, a.z/f);}
+    Coord3D& operator+=(const Coord3D& a) {x+=a.x; y+=a.y; z+=a.z; return *this;}
+    Coord3D& operator-=(const Coord3D& a) {x-=a.x; y-=a.y; z-=a.z; return *this;}
+    friend bool operator==(const Coord3D& a, const Coord3D& b) {return a.x==b.x && a.y==b.y && a.z==b.z;}
+    friend bool operator!=(const Coord3D& a, const Coord3D& b) {return !(a==b);}
+
+    /** Returns the squared length of the vector. */
+    double sqrLength() const {return x*x + y*y + z*z;}
+
+    /** Returns the length of the vector. */
+    double length() const {return sqrt(sqrLength());}
+
+    /** Returns the squared distance to a (omits the square root). */
+    double sqrdist(const Coord3D& a) const {
+        double dx = x-a.x, dy = y-a.y, dz = z-a.z;
+        return dx*dx + dy*dy + dz*dz;
+    }
+
+    /** Returns the distance to a. */
+    double distance(const Coord3D& a) const {return sqrt(sqrdist(a));}
+
+    /** Returns true if a is closer than the given distance (compares squared distances). */
+    bool isWithin(const Coord3D& a, double dist) const {return sqrdist(a) < dist*dist;}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const Coord3D& c)
+{
+    return os << "(" << c.x << "," << c.y << "," << c.z << ")";
+}
+
+#endif
+
@@ -0,0 +1,51 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_INETHASH_H
+#define __INET_INETHASH_H
+
+//
+// Portable hash tables. With C++11 compilers and MSVC, the std::unordered_map
+// and std::unordered_set classes are used, otherwise the TR1 versions.
+// Write inet_hash::unordered_map<Key,Value,Hasher> in the code, and always
+// pass an explicit hasher functor for non-builtin key types (so there is no
+// need to specialize hash templates in either namespace).
+//
+
+#include <stddef.h>
+#include "INETDefs.h"
+
+#if __cplusplus >= 201103L || defined(_MSC_VER)
+#  include <unordered_map>
+#  include <unordered_set>
+namespace inet_hash = std;
+#else
+#  include <tr1/unordered_map>
+#  include <tr1/unordered_set>
+namespace inet_hash = std::tr1;
+#endif
+
+/**
+ * Mixes value into a hash seed (same as boost::hash_combine).
+ */
+inline size_t inet_hash_combine(size_t seed, size_t value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+#endif
+
@@ -16,6 +16,8 @@
 //
 
 
+#include <map>
+#include <string>
 #include "ModuleAccess.h"
 
 inline bool isNode(cModule *mod)
@@ -24,34 +26,149 @@ inline bool isNode(cModule *mod)
     return props && props->getAsBool("node");
 }
 
-static cModule *findSubmodRecursive(cModule *curmod, const char *name)
+inline bool isInNode(cModule *mod)
+{
+    for (; mod; mod=mod->getParentModule())
+        if (isNode(mod))
+            return true;
+    return false;
+}
+
+static cModule *searchSubmodRecursive(cModule *curmod, const char *name)
 {
     for (cModule::SubmoduleIterator i(curmod); !i.end(); i++)
     {
         cModule *submod = i();
         if (!strcmp(submod->getFullName(), name))
             return submod;
-        cModule *foundmod = findSubmodRecursive(submod, name);
+        cModule *foundmod = searchSubmodRecursive(submod, name);
         if (foundmod)
             return foundmod;
     }
     return NULL;
 }
 
+#if OMNETPP_VERSION >= 0x0401
+
+Register_PerRunConfigOption(CFGID_MODULE_LOOKUP_CACHE, "module-lookup-cache", CFG_BOOL, "true",
+    "INET: whether to index the submodules by name for findModuleWherever() and findModuleWhereverInNode(). "
+    "This speeds up the initialization of large networks.");
+
+/**
+ * Caches the results of searchSubmodRecursive(). For every module searched
+ * in, it builds an index of the names of all modules below it (mapped to
+ * the first one in depth-first order, which is what the search returns),
+ * so that the recursive search runs once per module instead of once per
+ * lookup. It is only used above the nodes (modules with the @node
+ * property): a module there may be searched in by the initialize() of all
+ * modules of all nodes below it, so this turns the quadratic cost of such
+ * lookups into a linear one. Within a node a plain search is cheaper than
+ * building the index, because a node is small and searched only a few times.
+ *
+ * The cache is dropped when modules are created, deleted or moved, and
+ * when the network is deleted.
+ */
+class ModuleLookupCache : protected cListener
+{
+  protected:
+    typedef std::map<std::string, cModule *> NameIndex;
+    typedef std::map<cModule *, NameIndex> IndexMap;
+
+    bool subscribed;
+    bool enabled;
+    IndexMap indices;
+
+  protected:
+    static void addSubmodules(NameIndex& index, cModule *curmod)
+    {
+        for (cModule::SubmoduleIterator i(curmod); !i.end(); i++)
+        {
+            cModule *submod = i();
+            index.insert(std::make_pair(std::string(submod->getFullName()), submod)); // keeps the first one
+            addSubmodules(index, submod);
+        }
+    }
+
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj)
+    {
+        if (dynamic_cast<cPostModuleAddNotification *>(obj) || dynamic_cast<cPostModuleDeleteNotification *>(obj) ||
+            dynamic_cast<cPostModuleReparentNotification *>(obj))
+            indices.clear();
+    }
+
+    virtual void unsubscribedFrom(cComponent *component, simsignal_t signalID)
+    {
+        // the network is being deleted
+        indices.clear();
+        subscribed = false;
+    }
+
+  public:
+    ModuleLookupCache() {subscribed = false; enabled = false;}
+
+    cModule *findSubmodRecursive(cModule *curmod, const char *name)
+    {
+        if (!subscribed)
+        {
+            cModule *network = simulation.getSystemModule();
+            if (!network)
+                return searchSubmodRecursive(curmod, name);
+            network->subscribe(POST_MODEL_CHANGE, this);
+            subscribed = true;
+            enabled = ev.getConfig()->getAsBool(CFGID_MODULE_LOOKUP_CACHE);
+        }
+        if (!enabled)
+            return searchSubmodRecursive(curmod, name);
+
+        IndexMap::iterator it = indices.find(curmod);
+        if (it == indices.end())
+        {
+            it = indices.insert(std::make_pair(curmod, NameIndex())).first;
+            addSubmodules(it->second, curmod);
+        }
+        NameIndex::iterator found = it->second.find(name);
+        return found == it->second.end() ? NULL : found->second;
+    }
+};
+
+static ModuleLookupCache moduleLookupCache;
+
+static cModule *findSubmodRecursive(cModule *curmod, const char *name)
+{
+    return moduleLookupCache.findSubmodRecursive(curmod, name);
+}
+
+#else
+
+static cModule *findSubmodRecursive(cModule *curmod, const char *name)
+{
+    return searchSubmodRecursive(curmod, name);
+}
+
+#endif // OMNETPP_VERSION
+
 cModule *findModuleWherever(const char *name, cModule *from)
 {
+    // search directly up to the node, and use the index above it
+    bool inNode = isInNode(from);
     cModule *mod = NULL;
     for (cModule *curmod=from; !mod && curmod; curmod=curmod->getParentModule())
-        mod = findSubmodRecursive(curmod, name);
+    {
+        mod = inNode ? searchSubmodRecursive(curmod, name) : findSubmodRecursive(curmod, name);
+        if (inNode && isNode(curmod))
+            inNode = false;
+    }
     return mod;
 }
 
 cModule *findModuleWhereverInNode(const char *name, cModule *from)
 {
+    // the search stops at the node, so the index is only used if there is none
+    bool inNode = isInNode(from);
     cModule *mod = NULL;
     for (cModule *curmod=from; curmod; curmod=curmod->getParentModule())
     {
-        mod = findSubmodRecursive(curmod, name);
+        mod = inNode ? searchSubmodRecursive(curmod, name) : findSubmodRecursive(curmod, name);
         if (mod || isNode(curmod))
             break;
     }
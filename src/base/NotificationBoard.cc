@@ -16,6 +16,7 @@
 //
 
 
+#include <limits.h>
 #include <algorithm>
 #include "NotificationBoard.h"
 #include "NotifierConsts.h"
@@ -47,14 +48,72 @@ std::ostream& operator<<(std::ostream& os, const NotificationBoard::NotifiableVe
 }
 
 
+NotificationBoard::NotificationBoard()
+{
+    deliveryMsg = NULL;
+    deliveredNull = false;
+}
+
+NotificationBoard::~NotificationBoard()
+{
+    cancelAndDelete(deliveryMsg);
+}
+
 void NotificationBoard::initialize()
 {
-    WATCH_MAP(clientMap);
+    WATCH_VECTOR(clients);
+    WATCH_VECTOR(fireCounts);
+}
+
+void NotificationBoard::finish()
+{
+    if (!par("recordFireCounts").boolValue())
+        return;
+
+    for (int category=0; category<(int)fireCounts.size(); category++)
+    {
+        if (fireCounts[category] == 0)
+            continue;
+        char buf[80];
+        sprintf(buf, "fired %s", notificationCategoryName(category));
+        recordScalar(buf, fireCounts[category]);
+    }
 }
 
 void NotificationBoard::handleMessage(cMessage *msg)
 {
-    error("NotificationBoard doesn't handle messages, it can be accessed via direct method calls");
+    if (msg!=deliveryMsg)
+        error("NotificationBoard doesn't handle messages, it can be accessed via direct method calls");
+    deliverDeferredNotifications();
+}
+
+void NotificationBoard::deliverDeferredNotifications()
+{
+    // notifications fired during delivery will be delivered by the next deliveryMsg
+    std::vector<int> categories;
+    categories.swap(pendingCategories);
+
+    for (unsigned int k=0; k<categories.size(); k++)
+    {
+        int category = categories[k];
+        DeferredCategory& dc = deferredClients[category];
+        deliveredObjects.swap(dc.pendingObjects);
+        dc.pendingObjectIndex.clear();
+        deliveredNull = dc.pendingNull;
+        dc.pending = dc.pendingNull = false;
+
+        // clients may (un)subscribe during delivery, so index the vectors anew in every iteration;
+        // they may also delete objects, which forgetDetails() sets to NULL in deliveredObjects
+        for (unsigned int i=0; i<deferredClients[category].mergedClients.size(); i++)
+            deferredClients[category].mergedClients[i]->receiveChangeNotification(category, NULL);
+        for (unsigned int j=0; j<deliveredObjects.size(); j++)
+            for (unsigned int i=0; deliveredObjects[j] && i<deferredClients[category].perObjectClients.size(); i++)
+                deferredClients[category].perObjectClients[i]->receiveChangeNotification(category, deliveredObjects[j]);
+        if (deliveredNull)
+            for (unsigned int i=0; i<deferredClients[category].perObjectClients.size(); i++)
+                deferredClients[category].perObjectClients[i]->receiveChangeNotification(category, NULL);
+        deliveredObjects.clear();
+    }
 }
 
 
@@ -63,47 +122,132 @@ void NotificationBoard::subscribe(INotifiable *client, int category)
     Enter_Method("subscribe(%s)", notificationCategoryName(category));
 
     // find or create entry for this category
-    NotifiableVector& clients = clientMap[category];
+    ASSERT(category >= 0);
+    if (category >= (int)clients.size())
+        clients.resize(category + 1);
+    NotifiableVector& categoryClients = clients[category];
 
     // add client if not already there
-    if (std::find(clients.begin(), clients.end(), client) == clients.end())
-        clients.push_back(client);
+    if (std::find(categoryClients.begin(), categoryClients.end(), client) == categoryClients.end())
+        categoryClients.push_back(client);
 
     fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
-void NotificationBoard::unsubscribe(INotifiable *client, int category)
+void NotificationBoard::subscribeDeferred(INotifiable *client, int category, bool perObject)
 {
-    Enter_Method("unsubscribe(%s)", notificationCategoryName(category));
+    Enter_Method("subscribeDeferred(%s)", notificationCategoryName(category));
 
-    // find (or create) entry for this category
-    NotifiableVector& clients = clientMap[category];
+    // find or create entry for this category
+    ASSERT(category >= 0);
+    if (category >= (int)deferredClients.size())
+        deferredClients.resize(category + 1);
+    NotifiableVector& categoryClients = perObject ? deferredClients[category].perObjectClients : deferredClients[category].mergedClients;
 
-    // remove client if there
-    NotifiableVector::iterator it = std::find(clients.begin(), clients.end(), client);
-    if (it!=clients.end())
-        clients.erase(it);
+    // add client if not already there
+    if (std::find(categoryClients.begin(), categoryClients.end(), client) == categoryClients.end())
+        categoryClients.push_back(client);
 
     fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
-bool NotificationBoard::hasSubscribers(int category)
+void NotificationBoard::unsubscribe(INotifiable *client, int category)
 {
-    ClientMap::iterator it = clientMap.find(category);
-    return it!=clientMap.end() && !it->second.empty();
+    Enter_Method("unsubscribe(%s)", notificationCategoryName(category));
+
+    // remove client if there
+    if (category >= 0 && category < (int)clients.size())
+    {
+        NotifiableVector& categoryClients = clients[category];
+        NotifiableVector::iterator it = std::find(categoryClients.begin(), categoryClients.end(), client);
+        if (it!=categoryClients.end())
+            categoryClients.erase(it);
+    }
+    if (category >= 0 && category < (int)deferredClients.size())
+    {
+        DeferredCategory& dc = deferredClients[category];
+        NotifiableVector::iterator it = std::find(dc.mergedClients.begin(), dc.mergedClients.end(), client);
+        if (it!=dc.mergedClients.end())
+            dc.mergedClients.erase(it);
+        it = std::find(dc.perObjectClients.begin(), dc.perObjectClients.end(), client);
+        if (it!=dc.perObjectClients.end())
+            dc.perObjectClients.erase(it);
+    }
+
+    fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
 void NotificationBoard::fireChangeNotification(int category, const cPolymorphic *details)
 {
-    Enter_Method("fireChangeNotification(%s, %s)", notificationCategoryName(category),
-                 details?details->info().c_str() : "n/a");
+    ASSERT(category >= 0);
+    if (category >= (int)fireCounts.size())
+        fireCounts.resize(category + 1, 0);
+    fireCounts[category]++;
 
-    ClientMap::iterator it = clientMap.find(category);
-    if (it==clientMap.end())
+    if (!hasSubscribers(category))
         return;
-    NotifiableVector& clients = it->second;
-    for (NotifiableVector::iterator j=clients.begin(); j!=clients.end(); j++)
-        (*j)->receiveChangeNotification(category, details);
+
+    // only format the method call if it can be seen (details->info() is expensive)
+    cMethodCallContextSwitcher __ctx(this);
+    if (ev.isGUI())
+        __ctx.methodCall("fireChangeNotification(%s, %s)", notificationCategoryName(category),
+                         details?details->info().c_str() : "n/a");
+    else
+        __ctx.methodCallSilent();
+
+    // clients may subscribe or unsubscribe during delivery, which can
+    // reallocate the vectors, so index them anew in every iteration
+    for (unsigned int i=0; category<(int)clients.size() && i<clients[category].size(); i++)
+        clients[category][i]->receiveChangeNotification(category, details);
+
+    // queue it for the deferred subscribers
+    if (category < (int)deferredClients.size() && deferredClients[category].hasClients())
+    {
+        DeferredCategory& dc = deferredClients[category];
+        if (!dc.pending)
+        {
+            dc.pending = true;
+            pendingCategories.push_back(category);
+        }
+        if (!dc.perObjectClients.empty())
+        {
+            if (!details)
+                dc.pendingNull = true;
+            else if (dc.pendingObjectIndex.insert(std::make_pair(details, (int)dc.pendingObjects.size())).second)
+                dc.pendingObjects.push_back(details);
+        }
+        if (!deliveryMsg)
+        {
+            // created here, in our context, so that we own it (notifications
+            // may be fired before initialize(), and from other modules)
+            deliveryMsg = new cMessage("deliverDeferred");
+            deliveryMsg->setSchedulingPriority(SHRT_MAX); // after the other events of the same time step
+        }
+        if (!deliveryMsg->isScheduled())
+            scheduleAt(simTime(), deliveryMsg);
+    }
 }
 
+void NotificationBoard::forgetDetails(const cPolymorphic *details)
+{
+    std::vector<const cPolymorphic *>::iterator del = std::find(deliveredObjects.begin(), deliveredObjects.end(), details);
+    if (del!=deliveredObjects.end())
+    {
+        *del = NULL;
+        deliveredNull = true;
+    }
+
+    // only the categories fired in this time step may refer to it
+    for (unsigned int k=0; k<pendingCategories.size(); k++)
+    {
+        DeferredCategory& dc = deferredClients[pendingCategories[k]];
+        std::map<const cPolymorphic *, int>::iterator it = dc.pendingObjectIndex.find(details);
+        if (it!=dc.pendingObjectIndex.end())
+        {
+            dc.pendingObjects[it->second] = NULL;
+            dc.pendingObjectIndex.erase(it);
+            dc.pendingNull = true;
+        }
+    }
+}
 
@@ -20,8 +20,8 @@
 #define __INET_NOTIFICATIONBOARD_H
 
 #include <omnetpp.h>
-#include <map>
 #include <vector>
+#include <map>
 #include "ModuleAccess.h"
 #include "INotifiable.h"
 #include "NotifierConsts.h"
@@ -77,6 +77,24 @@
  * </pre>
  *
  *
+ * Clients that don't need to react to every single change (e.g. because
+ * they rebuild some data structure on each notification) can subscribe
+ * with subscribeDeferred() instead. Deferred notifications are collected,
+ * and delivered after the current event, at the end of the current
+ * simulation time step. Notifications of the same category are merged into
+ * one (with NULL details), or, if the client asked for it, into one per
+ * details object. In the latter case the board keeps the details pointers
+ * until the end of the time step, so a producer that deletes a details
+ * object earlier (e.g. RoutingTable the route of NF_IPv4_ROUTE_DELETED)
+ * must call forgetDetails() before deleting it. The pending notifications
+ * of a forgotten object are merged into one with NULL details.
+ *
+ * Subscribers are stored in a vector indexed by category, and
+ * fireChangeNotification() returns right away if the category has no
+ * subscribers. The method call (with the category name and the details
+ * string) is only shown in graphical user interfaces. The number of
+ * notifications fired in each category is counted, see getFireCount().
+ *
  * See NED file for additional info.
  *
  * @see INotifiable
@@ -86,11 +104,30 @@ class INET_API NotificationBoard : public cSimpleModule
 {
   public: // should be protected
     typedef std::vector<INotifiable *> NotifiableVector;
-    typedef std::map<int, NotifiableVector> ClientMap;
+    typedef std::vector<NotifiableVector> ClientVector;  // indexed by category
     friend std::ostream& operator<<(std::ostream&, const NotifiableVector&); // doesn't work in MSVC 6.0
 
+    struct DeferredCategory {
+        NotifiableVector mergedClients;     // notified once per category, with NULL details
+        NotifiableVector perObjectClients;  // notified once per details object
+        bool pending;                       // fired since the last delivery
+        bool pendingNull;                   // fired with NULL details, or with a forgotten object
+        std::vector<const cPolymorphic *> pendingObjects;  // in the order they were first fired; NULL if forgotten
+        std::map<const cPolymorphic *, int> pendingObjectIndex;  // index into pendingObjects
+        DeferredCategory() {pending = pendingNull = false;}
+        bool hasClients() const {return !mergedClients.empty() || !perObjectClients.empty();}
+    };
+    typedef std::vector<DeferredCategory> DeferredCategoryVector;  // indexed by category
+
   protected:
-    ClientMap clientMap;
+    ClientVector clients;
+    std::vector<long> fireCounts;  // indexed by category
+
+    DeferredCategoryVector deferredClients;
+    std::vector<int> pendingCategories;  // in the order they were first fired
+    std::vector<const cPolymorphic *> deliveredObjects;  // per-object notifications of the category being delivered
+    bool deliveredNull;  // whether the category being delivered also has a NULL entry
+    cMessage *deliveryMsg;  // scheduled when deferred notifications are pending; created on first use
 
   protected:
     /**
@@ -99,11 +136,24 @@ class INET_API NotificationBoard : public cSimpleModule
     virtual void initialize();
 
     /**
-     * Does nothing.
+     * Delivers the pending deferred notifications.
+     */
+    virtual void deliverDeferredNotifications();
+
+    /**
+     * Records the fire counts if the recordFireCounts parameter is set.
+     */
+    virtual void finish();
+
+    /**
+     * Handles the self-message that delivers deferred notifications.
      */
     virtual void handleMessage(cMessage *msg);
 
   public:
+    NotificationBoard();
+    virtual ~NotificationBoard();
+
     /** @name Methods for consumers of change notifications */
     //@{
     /**
@@ -112,7 +162,16 @@ class INET_API NotificationBoard : public cSimpleModule
     virtual void subscribe(INotifiable *client, int category);
 
     /**
-     * Unsubscribe from changes of the given category
+     * Subscribe to changes of the given category with deferred delivery:
+     * the client is notified at the end of the simulation time step, once
+     * for all changes (with NULL details), or if perObject is true, once for
+     * each distinct details object.
+     */
+    virtual void subscribeDeferred(INotifiable *client, int category, bool perObject=false);
+
+    /**
+     * Unsubscribe from changes of the given category (both immediate and
+     * deferred subscriptions)
      */
     virtual void unsubscribe(INotifiable *client, int category);
 
@@ -124,7 +183,11 @@ class INET_API NotificationBoard : public cSimpleModule
      * The flag should be refreshed on each NF_SUBSCRIBERLIST_CHANGED
      * notification.
      */
-    virtual bool hasSubscribers(int category);
+    virtual bool hasSubscribers(int category) {
+        return category >= 0 &&
+               ((category < (int)clients.size() && !clients[category].empty()) ||
+                (category < (int)deferredClients.size() && deferredClients[category].hasClients()));
+    }
     //@}
 
     /** @name Methods for producers of change notifications */
@@ -136,7 +199,23 @@ class INET_API NotificationBoard : public cSimpleModule
      * that changed, old value, new value, etc).
      */
     virtual void fireChangeNotification(int category, const cPolymorphic *details=NULL);
+
+    /**
+     * Tells NotificationBoard that the given details object is about to be
+     * deleted. Pending deferred notifications for it are merged into one
+     * with NULL details, so that per-object subscribers never receive a
+     * dangling pointer.
+     */
+    virtual void forgetDetails(const cPolymorphic *details);
     //@}
+
+    /**
+     * Returns the number of notifications fired in the given category so
+     * far, including the ones that had no subscribers.
+     */
+    long getFireCount(int category) const {
+        return category >= 0 && category < (int)fireCounts.size() ? fireCounts[category] : 0;
+    }
 };
 
 /**
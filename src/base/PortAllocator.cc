@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "PortAllocator.h"
+
+
+// index of the lowest set bit (bits must be nonzero)
+static inline int lowestBit(uint64 bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int k = 0;
+    while (!(bits & 1)) {bits >>= 1; k++;}
+    return k;
+#endif
+}
+
+PortAllocator::PortAllocator(int rangeStart, int rangeEnd)
+{
+    if (rangeStart<0 || rangeEnd>65536 || rangeStart>=rangeEnd)
+        throw cRuntimeError("PortAllocator: invalid port range %d..%d", rangeStart, rangeEnd);
+    this->rangeStart = rangeStart;
+    this->rangeEnd = rangeEnd;
+    lastPort = rangeStart;
+    numUsedPorts = 0;
+    int n = rangeEnd - rangeStart;
+    usedBitmap.resize((n+63)/64, 0);
+    useCount.resize(n, 0);
+}
+
+bool PortAllocator::isUsed(int port) const
+{
+    if (!isInRange(port))
+        return false;
+    int k = port - rangeStart;
+    return (usedBitmap[k>>6] >> (k&63)) & 1;
+}
+
+void PortAllocator::addUse(int port)
+{
+    if (!isInRange(port))
+        return;
+    int k = port - rangeStart;
+    if (useCount[k]++ == 0)
+    {
+        usedBitmap[k>>6] |= (uint64)1 << (k&63);
+        numUsedPorts++;
+    }
+}
+
+void PortAllocator::removeUse(int port)
+{
+    if (!isInRange(port))
+        return;
+    int k = port - rangeStart;
+    if (useCount[k]==0)
+        return;
+    if (--useCount[k] == 0)
+    {
+        usedBitmap[k>>6] &= ~((uint64)1 << (k&63));
+        numUsedPorts--;
+    }
+}
+
+int PortAllocator::findZeroBit(int from, int to) const
+{
+    // returns the index of the first zero bit in [from,to), or -1
+    while (from<to)
+    {
+        uint64 freeBits = ~usedBitmap[from>>6] & (~(uint64)0 << (from&63));
+        if (freeBits)
+        {
+            int k = (from & ~63) + lowestBit(freeBits);
+            return k<to ? k : -1;
+        }
+        from = (from & ~63) + 64;
+    }
+    return -1;
+}
+
+int PortAllocator::findFreePort()
+{
+    int n = rangeEnd - rangeStart;
+    int start = lastPort + 1 - rangeStart;
+    if (start>=n)
+        start = 0;
+
+    int k = findZeroBit(start, n);
+    if (k<0)
+        k = findZeroBit(0, start);
+    if (k<0)
+        return -1;
+
+    lastPort = rangeStart + k;
+    return lastPort;
+}
+
@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_PORTALLOCATOR_H
+#define __INET_PORTALLOCATOR_H
+
+#include <vector>
+#include "INETDefs.h"
+
+
+/**
+ * Keeps track of the used ports in an ephemeral port range, and finds
+ * free ones quickly. Ports are stored in a bitmap (one bit per port, set
+ * if the port is in use), so a free port is found by scanning 64 ports
+ * at a time. Ports may be used several times (e.g. TCP connections forked
+ * from a listening one share its port); a port becomes free when all uses
+ * have been released.
+ *
+ * Used by TCP and UDP.
+ */
+class INET_API PortAllocator
+{
+  protected:
+    int rangeStart;  // first port of the range
+    int rangeEnd;    // last port of the range +1
+    int lastPort;    // last port returned by findFreePort(); search starts after it
+    int numUsedPorts;
+    std::vector<uint64> usedBitmap;       // bit k: port rangeStart+k is in use
+    std::vector<unsigned short> useCount; // number of uses per port
+
+  protected:
+    int findZeroBit(int from, int to) const;
+
+  public:
+    /**
+     * Ctor. The range is [rangeStart, rangeEnd).
+     */
+    PortAllocator(int rangeStart=1024, int rangeEnd=5000);
+
+    /**
+     * Returns true if the port belongs to the range.
+     */
+    bool isInRange(int port) const {return port>=rangeStart && port<rangeEnd;}
+
+    /**
+     * Returns true if the port is in use. Ports outside the range
+     * are never in use.
+     */
+    bool isUsed(int port) const;
+
+    /**
+     * Registers a use of the port. Ports outside the range are ignored.
+     */
+    void addUse(int port);
+
+    /**
+     * Releases a use of the port. Ports outside the range and ports
+     * not in use are ignored.
+     */
+    void removeUse(int port);
+
+    /**
+     * Returns a free port, searching from the one after the previously
+     * returned port, wrapping around at the end of the range. The port is
+     * NOT marked as used; call addUse() when it actually gets used.
+     * Returns -1 if all ports are in use.
+     */
+    int findFreePort();
+
+    /**
+     * Returns the previously returned port.
+     */
+    int getLastPort() const {return lastPort;}
+
+    /**
+     * Returns the number of ports in use.
+     */
+    int getNumUsedPorts() const {return numUsedPorts;}
+
+    /** @name Range boundaries */
+    //@{
+    int getRangeStart() const {return rangeStart;}
+    int getRangeEnd() const {return rangeEnd;}
+    //@}
+};
+
+/**
+ * For WATCH(): shows the last allocated port and the number of ports in use.
+ */
+inline std::ostream& operator<<(std::ostream& os, const PortAllocator& ports)
+{
+    return os << "last port " << ports.getLastPort() << ", " << ports.getNumUsedPorts() << " ports in use";
+}
+
+#endif
+
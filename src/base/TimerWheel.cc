@@ -0,0 +1,282 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "TimerWheel.h"
+
+Register_Class(WheelTimer);
+
+#define SLOT_MASK  (TimerWheel::SLOTS-1)
+
+// index of the lowest set bit (bits must be nonzero)
+static inline int lowestBit(uint64 bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int k = 0;
+    while (!(bits & 1)) {bits >>= 1; k++;}
+    return k;
+#endif
+}
+
+void WheelTimer::reset()
+{
+    wheel = NULL;
+    tick = 0;
+    insertOrder = 0;
+    level = slot = 0;
+    prev = next = NULL;
+}
+
+WheelTimer::~WheelTimer()
+{
+    if (wheel)
+        wheel->cancel(this);
+}
+
+
+TimerWheel::TimerWheel()
+{
+    owner = NULL;
+    tickMsg = NULL;
+    granularity = 0.001;
+    currentTick = 0;
+    insertCounter = 0;
+    firing = false;
+    numPending = 0;
+    for (int k=0; k<LEVELS; k++)
+    {
+        occupied[k] = 0;
+        for (int i=0; i<SLOTS; i++)
+            slots[k][i] = NULL;
+    }
+    overflow = NULL;
+    numTimersScheduled = numTickEvents = 0;
+}
+
+TimerWheel::~TimerWheel()
+{
+    // detach timers still pending, so that they can be deleted later
+    for (int k=0; k<LEVELS; k++)
+        for (int i=0; i<SLOTS; i++)
+            while (slots[k][i])
+                cancel(slots[k][i]);
+    while (overflow)
+        cancel(overflow);
+
+    if (owner && tickMsg)
+        owner->cancelAndDelete(tickMsg);
+}
+
+void TimerWheel::init(cSimpleModule *owner, simtime_t granularity, const char *tickMsgName)
+{
+    if (granularity<=0)
+        opp_error("TimerWheel: granularity must be positive");
+    this->owner = owner;
+    this->granularity = SIMTIME_DBL(granularity);
+    currentTick = getTickOf(simTime());
+    tickMsg = new cMessage(tickMsgName);
+}
+
+void TimerWheel::link(WheelTimer *timer, short level, short slot)
+{
+    WheelTimer *&head = level<0 ? overflow : slots[level][slot];
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = head;
+    if (head)
+        head->prev = timer;
+    head = timer;
+    if (level>=0)
+        occupied[level] |= (uint64)1 << slot;
+}
+
+void TimerWheel::unlink(WheelTimer *timer)
+{
+    WheelTimer *&head = timer->level<0 ? overflow : slots[timer->level][timer->slot];
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        head = timer->next;
+    if (timer->next)
+        timer->next->prev = timer->prev;
+    timer->prev = timer->next = NULL;
+    if (!head && timer->level>=0)
+        occupied[timer->level] &= ~((uint64)1 << timer->slot);
+}
+
+void TimerWheel::insert(WheelTimer *timer)
+{
+    // the lowest level whose enclosing block contains both now and the expiry
+    int64 t = timer->tick;
+    for (int k=0; k<LEVELS; k++)
+    {
+        int shift = (k+1)*LEVEL_BITS;
+        if ((t >> shift) == (currentTick >> shift))
+        {
+            link(timer, k, (short)((t >> (k*LEVEL_BITS)) & SLOT_MASK));
+            return;
+        }
+    }
+    link(timer, -1, 0);
+}
+
+void TimerWheel::cascade(WheelTimer *list)
+{
+    while (list)
+    {
+        WheelTimer *timer = list;
+        list = list->next;
+        insert(timer);
+    }
+}
+
+void TimerWheel::advance(int64 targetTick)
+{
+    // Note: it is assumed that no timer expires before targetTick, so the
+    // slots we jump over are all empty, except the ones we land in.
+    if (targetTick<=currentTick)
+        return;
+    int64 oldTick = currentTick;
+    currentTick = targetTick;
+
+    if ((targetTick >> (LEVELS*LEVEL_BITS)) != (oldTick >> (LEVELS*LEVEL_BITS)))
+    {
+        WheelTimer *list = overflow;
+        overflow = NULL;
+        cascade(list);
+    }
+
+    for (int k=LEVELS-1; k>0; k--)
+    {
+        int shift = k*LEVEL_BITS;
+        if ((targetTick >> shift) != (oldTick >> shift))
+        {
+            int i = (int)((targetTick >> shift) & SLOT_MASK);
+            WheelTimer *list = slots[k][i];
+            slots[k][i] = NULL;
+            occupied[k] &= ~((uint64)1 << i);
+            cascade(list);
+        }
+    }
+}
+
+WheelTimer *TimerWheel::findEarliest(WheelTimer *list)
+{
+    WheelTimer *best = list;
+    for (WheelTimer *timer = list; timer; timer = timer->next)
+        if (timer->expiry < best->expiry || (timer->expiry == best->expiry && timer->insertOrder < best->insertOrder))
+            best = timer;
+    return best;
+}
+
+WheelTimer *TimerWheel::findNext() const
+{
+    // the first non-empty slot, searching from the lowest level, contains
+    // the earliest timer
+    for (int k=0; k<LEVELS; k++)
+    {
+        int i = (int)((currentTick >> (k*LEVEL_BITS)) & SLOT_MASK);
+        uint64 bits = occupied[k] & (~(uint64)0 << i);
+        if (bits)
+            return findEarliest(slots[k][lowestBit(bits)]);
+    }
+    return overflow ? findEarliest(overflow) : NULL;
+}
+
+void TimerWheel::arm(simtime_t t)
+{
+    if (firing)
+        return;  // rearm() will take care
+    if (tickMsg->isScheduled())
+    {
+        if (tickMsg->getArrivalTime() <= t)
+            return;
+        owner->cancelEvent(tickMsg);
+    }
+    owner->scheduleAt(t, tickMsg);
+}
+
+void TimerWheel::scheduleAt(simtime_t t, WheelTimer *timer)
+{
+    if (timer->isPending())
+        opp_error("TimerWheel::scheduleAt(): timer (%s)%s is currently scheduled, use cancel() before rescheduling",
+                  timer->getClassName(), timer->getFullName());
+    if (t < simTime())
+        opp_error("TimerWheel::scheduleAt(): timer (%s)%s: cannot schedule into the past",
+                  timer->getClassName(), timer->getFullName());
+
+    timer->wheel = this;
+    timer->expiry = t;
+    timer->tick = getTickOf(t);
+    timer->insertOrder = insertCounter++;
+    insert(timer);
+    numPending++;
+    numTimersScheduled++;
+
+    arm(t);
+}
+
+WheelTimer *TimerWheel::cancel(WheelTimer *timer)
+{
+    if (timer->wheel==this)
+    {
+        unlink(timer);
+        timer->wheel = NULL;
+        numPending--;
+    }
+    else if (timer->cMessage::isScheduled())
+    {
+        owner->cancelEvent(timer);
+    }
+    return timer;
+}
+
+WheelTimer *TimerWheel::popExpired()
+{
+    if (!firing)
+    {
+        firing = true;
+        numTickEvents++;
+    }
+
+    simtime_t now = simTime();
+    advance(getTickOf(now));
+
+    // everything that expires by now is in the current level-0 slot
+    WheelTimer *list = slots[0][currentTick & SLOT_MASK];
+    if (!list)
+        return NULL;
+    WheelTimer *timer = findEarliest(list);
+    if (timer->expiry > now)
+        return NULL;
+
+    unlink(timer);
+    timer->wheel = NULL;
+    numPending--;
+    return timer;
+}
+
+void TimerWheel::rearm()
+{
+    firing = false;
+    WheelTimer *timer = findNext();
+    if (timer)
+        arm(timer->expiry);
+}
+
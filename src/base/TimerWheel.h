@@ -0,0 +1,200 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_TIMERWHEEL_H
+#define __INET_TIMERWHEEL_H
+
+#include "INETDefs.h"
+
+class TimerWheel;
+
+
+/**
+ * A timer that can be scheduled in a TimerWheel instead of the future
+ * event set. It is an ordinary cMessage otherwise, so context pointers,
+ * names and kinds can be used the same way as with self-messages.
+ *
+ * Use isPending() and getExpiryTime() instead of isScheduled() and
+ * getArrivalTime(): the latter are inherited from cMessage, and only
+ * reflect the state in the future event set.
+ */
+class INET_API WheelTimer : public cMessage
+{
+    friend class TimerWheel;
+
+  private:
+    TimerWheel *wheel;   // non-NULL while pending in a wheel
+    simtime_t expiry;    // exact expiry time
+    int64 tick;          // expiry in wheel ticks
+    uint64 insertOrder;  // tie breaker for timers with the same expiry
+    short level;         // wheel level (-1: overflow list)
+    short slot;          // slot within the level
+    WheelTimer *prev;
+    WheelTimer *next;
+
+  private:
+    void reset();
+
+  public:
+    WheelTimer(const char *name=NULL, short kind=0) : cMessage(name, kind) {reset();}
+    WheelTimer(const WheelTimer& other) : cMessage(other) {reset();}
+    virtual ~WheelTimer();
+    WheelTimer& operator=(const WheelTimer& other) {cMessage::operator=(other); return *this;}
+    virtual WheelTimer *dup() const {return new WheelTimer(*this);}
+
+    /**
+     * Returns true if the timer is pending in a wheel or in the FES.
+     */
+    bool isPending() const {return wheel!=NULL || isScheduled();}
+
+    /**
+     * Returns the expiry time if the timer is pending in a wheel, and
+     * the arrival time otherwise.
+     */
+    simtime_t getExpiryTime() const {return wheel ? expiry : getArrivalTime();}
+};
+
+
+/**
+ * Hierarchical timing wheel that multiplexes many logical timers of a
+ * module onto a single self-message in the future event set (FES).
+ * Scheduling and cancelling a timer are O(1) operations that do not touch
+ * the FES, except when the new timer expires before everything else that
+ * is pending; this makes it suitable for protocol timers that are
+ * cancelled and rescheduled very frequently (retransmission, delayed ACK,
+ * heartbeat timers, etc.)
+ *
+ * Timers are hashed into LEVELS levels of SLOTS slots each; a level-0 slot
+ * covers one tick (the granularity), and a level-k slot covers SLOTS^k ticks.
+ * Timers beyond the last level go into an overflow list. Slots of the higher
+ * levels are cascaded down on demand, as time advances. Expiry is exact:
+ * the tick message is always scheduled at the exact expiry time of the
+ * earliest timer, and timers that expire at the same time fire in the
+ * order they were scheduled. The granularity only affects how timers are
+ * distributed among the slots.
+ *
+ * Cancelling the earliest timer leaves the tick message alone; it will
+ * simply fire without expired timers, and get rearmed for the next one.
+ *
+ * Usage from the owner module:
+ * <pre>
+ *   void handleMessage(cMessage *msg)
+ *   {
+ *       if (timerWheel.isTickMessage(msg))
+ *       {
+ *           WheelTimer *timer;
+ *           while ((timer = timerWheel.popExpired()) != NULL)
+ *               processTimer(timer);
+ *           timerWheel.rearm();
+ *       }
+ *       ...
+ *   }
+ * </pre>
+ */
+class INET_API TimerWheel
+{
+  public:
+    enum { LEVEL_BITS = 6, SLOTS = 1 << LEVEL_BITS, LEVELS = 4 };
+
+  protected:
+    cSimpleModule *owner;
+    cMessage *tickMsg;
+    double granularity;
+    int64 currentTick;
+    uint64 insertCounter;
+    bool firing;         // between popExpired() and rearm()
+    int numPending;
+
+    WheelTimer *slots[LEVELS][SLOTS];
+    uint64 occupied[LEVELS];   // bitmaps of non-empty slots
+    WheelTimer *overflow;
+
+    // statistics
+    long numTimersScheduled;
+    long numTickEvents;
+
+  protected:
+    int64 getTickOf(simtime_t t) const {return (int64)floor(SIMTIME_DBL(t) / granularity);}
+    void link(WheelTimer *timer, short level, short slot);
+    void unlink(WheelTimer *timer);
+    void insert(WheelTimer *timer);
+    void cascade(WheelTimer *list);
+    void advance(int64 targetTick);
+    static WheelTimer *findEarliest(WheelTimer *list);
+    WheelTimer *findNext() const;
+    void arm(simtime_t t);
+
+  public:
+    TimerWheel();
+    ~TimerWheel();
+
+    /**
+     * Must be called from the owner module's initialize(). The tick message
+     * is created in the context of the owner module.
+     */
+    void init(cSimpleModule *owner, simtime_t granularity, const char *tickMsgName="timerWheel");
+
+    /**
+     * Schedules the timer to expire at time t, like cSimpleModule::scheduleAt().
+     * Throws an error if the timer is already scheduled or t is in the past.
+     */
+    void scheduleAt(simtime_t t, WheelTimer *timer);
+
+    /**
+     * Cancels the timer if it is pending, and returns it. Like
+     * cSimpleModule::cancelEvent(), it is a no-op for timers not scheduled.
+     */
+    WheelTimer *cancel(WheelTimer *timer);
+
+    /**
+     * Returns true if msg is the tick message of this wheel.
+     */
+    bool isTickMessage(cMessage *msg) const {return msg==tickMsg;}
+
+    /**
+     * Removes and returns the earliest timer that has expired by now, or
+     * NULL if there is none. Should be called repeatedly when the tick
+     * message arrives, followed by rearm().
+     */
+    WheelTimer *popExpired();
+
+    /**
+     * Reschedules the tick message for the earliest pending timer.
+     */
+    void rearm();
+
+    /**
+     * Returns the number of pending timers.
+     */
+    int getNumPending() const {return numPending;}
+
+    /**
+     * Returns the number of scheduleAt() calls so far. Together with
+     * getNumTickEvents(), owner modules record it as a scalar, so that the
+     * number of FES events saved by the wheel can be seen.
+     */
+    long getNumTimersScheduled() const {return numTimersScheduled;}
+
+    /**
+     * Returns the number of tick messages processed so far, i.e. the number
+     * of FES events the wheel has actually generated.
+     */
+    long getNumTickEvents() const {return numTickEvents;}
+};
+
+#endif
+
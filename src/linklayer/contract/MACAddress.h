@@ -162,6 +162,19 @@ class INET_API MACAddress
 
 };
 
+/**
+ * Hash function for MACAddress, for use with hash tables (see INETHash.h).
+ */
+struct MACAddressHash
+{
+    size_t operator()(const MACAddress& addr) const {
+        size_t h = 0;
+        for (unsigned int i = 0; i < 6; i++)
+            h = h * 31 + addr.getAddressByte(i);
+        return h;
+    }
+};
+
 inline std::ostream& operator<<(std::ostream& os, const MACAddress& mac)
 {
     return os << mac.str();
@@ -0,0 +1,71 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Ieee80211AggregateFrame.h"
+#include "Ieee80211Consts.h"
+
+Register_Class(Ieee80211AggregateFrame);
+
+
+Ieee80211AggregateFrame& Ieee80211AggregateFrame::operator=(const Ieee80211AggregateFrame& other)
+{
+    if (this == &other)
+        return *this;
+    Ieee80211DataFrame::operator=(other);
+    deleteSubframes();
+    copySubframes(other);
+    return *this;
+}
+
+void Ieee80211AggregateFrame::copySubframes(const Ieee80211AggregateFrame& other)
+{
+    for (std::list<Ieee80211DataFrame *>::const_iterator it = other.subframes.begin(); it != other.subframes.end(); ++it)
+    {
+        Ieee80211DataFrame *frame = (*it)->dup();
+        take(frame);
+        subframes.push_back(frame);
+    }
+}
+
+void Ieee80211AggregateFrame::deleteSubframes()
+{
+    while (!subframes.empty())
+    {
+        Ieee80211DataFrame *frame = subframes.front();
+        subframes.pop_front();
+        dropAndDelete(frame);
+    }
+}
+
+void Ieee80211AggregateFrame::addSubframe(Ieee80211DataFrame *frame)
+{
+    take(frame);
+    subframes.push_back(frame);
+    addByteLength(AMSDU_SUBFRAME_HEADER_BYTES + frame->getByteLength() - DATA_FRAME_HEADER_BYTES);
+}
+
+Ieee80211DataFrame *Ieee80211AggregateFrame::removeFirstSubframe()
+{
+    if (subframes.empty())
+        return NULL;
+
+    Ieee80211DataFrame *frame = subframes.front();
+    subframes.pop_front();
+    drop(frame);
+    return frame;
+}
+
@@ -0,0 +1,72 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_AGGREGATEFRAME_H
+#define IEEE80211_AGGREGATEFRAME_H
+
+#include <list>
+#include "Ieee80211Frame_m.h"
+
+
+/**
+ * A data frame that carries several data frames (MSDUs) for the same
+ * receiver, like an 802.11n A-MSDU. It is sent after a single channel
+ * access and acknowledged with a single ACK; the receiving MAC passes
+ * the subframes up one by one.
+ *
+ * The length of the aggregate is its own data frame header, plus for each
+ * subframe the A-MSDU subframe header and the subframe without its
+ * 802.11 header (see addSubframe()).
+ *
+ * @see Ieee80211Mac
+ */
+class INET_API Ieee80211AggregateFrame : public Ieee80211DataFrame
+{
+  protected:
+    std::list<Ieee80211DataFrame *> subframes;
+
+  private:
+    void copySubframes(const Ieee80211AggregateFrame& other);
+    void deleteSubframes();
+
+  public:
+    Ieee80211AggregateFrame(const char *name=NULL, int kind=0) : Ieee80211DataFrame(name, kind) {}
+    Ieee80211AggregateFrame(const Ieee80211AggregateFrame& other) : Ieee80211DataFrame(other) {copySubframes(other);}
+    virtual ~Ieee80211AggregateFrame() {deleteSubframes();}
+    Ieee80211AggregateFrame& operator=(const Ieee80211AggregateFrame& other);
+    virtual Ieee80211AggregateFrame *dup() const {return new Ieee80211AggregateFrame(*this);}
+
+    /**
+     * Returns the number of subframes.
+     */
+    int getNumSubframes() const {return subframes.size();}
+
+    /**
+     * Appends the frame to the aggregate, and increases the length of the
+     * aggregate accordingly. The aggregate takes ownership of the frame.
+     */
+    virtual void addSubframe(Ieee80211DataFrame *frame);
+
+    /**
+     * Removes and returns the first subframe, or returns NULL if there are
+     * no more. The length of the aggregate is not changed.
+     */
+    virtual Ieee80211DataFrame *removeFirstSubframe();
+};
+
+#endif
+
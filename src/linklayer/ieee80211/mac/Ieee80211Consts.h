@@ -30,6 +30,17 @@ const unsigned int LENGTH_RTS = 160;
 const unsigned int LENGTH_CTS = 112;
 const unsigned int LENGTH_ACK = 112;
 
+// header lengths in bytes
+// XXX the data frame header is also in Ieee80211Frame.msg
+const int DATA_FRAME_HEADER_BYTES = 34;
+const int AMSDU_SUBFRAME_HEADER_BYTES = 14;  // DA, SA, length; padding is not modelled
+
+/** Maximum length of an aggregate frame (A-MSDU) in bytes */
+const int MAX_AMSDU_LENGTH = 7935;
+
+/** Maximum number of fragments of a frame (the fragment number is 4 bits) */
+const int MAX_NUM_FRAGMENTS = 16;
+
 // time slot ST, short interframe space SIFS, distributed interframe
 // space DIFS, and extended interframe space EIFS
 
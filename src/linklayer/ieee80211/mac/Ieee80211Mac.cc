@@ -48,6 +48,7 @@ Register_Enum(RadioState,
  */
 Ieee80211Mac::Ieee80211Mac()
 {
+    deadlineTimer = NULL;
     endSIFS = NULL;
     endDIFS = NULL;
     endBackoff = NULL;
@@ -55,10 +56,12 @@ Ieee80211Mac::Ieee80211Mac()
     endReserve = NULL;
     mediumStateChange = NULL;
     pendingRadioConfigMsg = NULL;
+    queueModule = NULL;
 }
 
 Ieee80211Mac::~Ieee80211Mac()
 {
+    cancelAndDelete(deadlineTimer);
     cancelAndDelete(endSIFS);
     cancelAndDelete(endDIFS);
     cancelAndDelete(endBackoff);
@@ -101,6 +104,17 @@ void Ieee80211Mac::initialize(int stage)
         if (cwMinBroadcast == -1) cwMinBroadcast = 31;
         ASSERT(cwMinBroadcast >= 0);
 
+        fragmentationThreshold = par("fragmentationThreshold");
+        if (fragmentationThreshold <= DATA_FRAME_HEADER_BYTES)
+            error("fragmentationThreshold must be larger than the data frame header (%d bytes)", DATA_FRAME_HEADER_BYTES);
+
+        maxAggregateFrames = par("maxAggregateFrames");
+        if (maxAggregateFrames < 1)
+            error("maxAggregateFrames must be at least 1");
+        maxAggregateLength = par("maxAggregateLength");
+        if (maxAggregateLength > MAX_AMSDU_LENGTH)
+            error("maxAggregateLength cannot be larger than %d bytes", MAX_AMSDU_LENGTH);
+
         const char *addressString = par("address");
         if (!strcmp(addressString, "auto")) {
             // assign automatic address
@@ -115,12 +129,22 @@ void Ieee80211Mac::initialize(int stage)
         nb->subscribe(this, NF_RADIOSTATE_CHANGED);
 
         // initalize self messages
-        endSIFS = new cMessage("SIFS");
-        endDIFS = new cMessage("DIFS");
-        endBackoff = new cMessage("Backoff");
-        endTimeout = new cMessage("Timeout");
-        endReserve = new cMessage("Reserve");
-        mediumStateChange = new cMessage("MediumStateChange");
+        deadlineTimer = new cMessage("Timer");
+        endSIFS = new cMessage("SIFS", TIMER_SIFS);
+        endDIFS = new cMessage("DIFS", TIMER_DIFS);
+        endBackoff = new cMessage("Backoff", TIMER_BACKOFF);
+        endTimeout = new cMessage("Timeout", TIMER_TIMEOUT);
+        endReserve = new cMessage("Reserve", TIMER_RESERVE);
+        mediumStateChange = new cMessage("MediumStateChange", TIMER_MEDIUMSTATECHANGE);
+        timers[TIMER_SIFS] = endSIFS;
+        timers[TIMER_DIFS] = endDIFS;
+        timers[TIMER_BACKOFF] = endBackoff;
+        timers[TIMER_TIMEOUT] = endTimeout;
+        timers[TIMER_RESERVE] = endReserve;
+        timers[TIMER_MEDIUMSTATECHANGE] = mediumStateChange;
+        for (int i = 0; i < NUM_TIMERS; i++)
+            timerDeadlines[i] = -1;
+        timerSequenceNumber = 0;
 
         // interface
         registerInterface();
@@ -135,6 +159,7 @@ void Ieee80211Mac::initialize(int stage)
         radioState = RadioState::IDLE;
         retryCounter = 0;
         backoffPeriod = -1;
+        backoffStart = 0;
         backoff = false;
         lastReceiveFailed = false;
         nav = false;
@@ -148,6 +173,9 @@ void Ieee80211Mac::initialize(int stage)
         numReceived = 0;
         numSentBroadcast = 0;
         numReceivedBroadcast = 0;
+        numSentAggregates = 0;
+        numAggregatedFrames = 0;
+        numFragmented = 0;
         stateVector.setName("State");
         stateVector.setEnum("Ieee80211Mac");
         radioStateVector.setName("RadioState");
@@ -168,9 +196,19 @@ void Ieee80211Mac::initialize(int stage)
         WATCH(numReceived);
         WATCH(numSentBroadcast);
         WATCH(numReceivedBroadcast);
+        WATCH(numSentAggregates);
+        WATCH(numAggregatedFrames);
+        WATCH(numFragmented);
     }
 }
 
+void Ieee80211Mac::finish()
+{
+    recordScalar("aggregate frames", numSentAggregates);
+    recordScalar("frames sent in aggregates", numAggregatedFrames);
+    recordScalar("fragmented frames", numFragmented);
+}
+
 void Ieee80211Mac::registerInterface()
 {
     IInterfaceTable *ift = InterfaceTableAccess().getIfExists();
@@ -214,10 +252,12 @@ void Ieee80211Mac::initializeQueueModule()
         cModule *module = getParentModule()->getSubmodule(par("queueModule").stringValue());
         queueModule = check_and_cast<IPassiveQueue *>(module);
 
-        EV << "Requesting first two frames from queue module\n";
-        queueModule->requestPacket();
-        // needed for backoff: mandatory if next message is already present
-        queueModule->requestPacket();
+        // one more is needed for backoff: mandatory if next message is already present;
+        // with aggregation, as many as can be sent in one aggregate frame
+        int numFrames = maxAggregateFrames + 1;
+        EV << "Requesting first " << numFrames << " frames from queue module\n";
+        for (int i = 0; i < numFrames; i++)
+            queueModule->requestPacket();
     }
 }
 
@@ -226,6 +266,12 @@ void Ieee80211Mac::initializeQueueModule()
  */
 void Ieee80211Mac::handleSelfMsg(cMessage *msg)
 {
+    if (msg == deadlineTimer)
+    {
+        handleDeadlineTimer();
+        return;
+    }
+
     EV << "received self message: " << msg << endl;
 
     if (msg == endReserve)
@@ -236,19 +282,17 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
 
 void Ieee80211Mac::handleUpperMsg(cPacket *msg)
 {
-    // check for queue overflow
-    if (maxQueueSize && (int)transmissionQueue.size() == maxQueueSize)
+    // check for queue overflow; the queue may already be longer than the
+    // limit, because all fragments of a frame are queued at once
+    if (maxQueueSize && (int)transmissionQueue.size() >= maxQueueSize)
     {
         EV << "message " << msg << " received from higher layer but MAC queue is full, dropping message\n";
         delete msg;
         return;
     }
 
-    // must be a Ieee80211DataOrMgmtFrame, within the max size because we don't support fragmentation
+    // must be a Ieee80211DataOrMgmtFrame
     Ieee80211DataOrMgmtFrame *frame = check_and_cast<Ieee80211DataOrMgmtFrame *>(msg);
-    if (frame->getByteLength() > fragmentationThreshold)
-        error("message from higher layer (%s)%s is too long for 802.11b, %d bytes (fragmentation is not supported yet)",
-              msg->getClassName(), msg->getName(), (int)(msg->getByteLength()));
     EV << "frame " << frame << " received from higher layer, receiver = " << frame->getReceiverAddress() << endl;
 
     ASSERT(!frame->getReceiverAddress().isUnspecified());
@@ -258,7 +302,11 @@ void Ieee80211Mac::handleUpperMsg(cPacket *msg)
     frame->setSequenceNumber(sequenceNumber);
     sequenceNumber = (sequenceNumber+1) % 4096;  //XXX seqNum must be checked upon reception of frames!
 
-    transmissionQueue.push_back(frame);
+    // only frames with an individual receiver address are fragmented, see spec 9.4
+    if (frame->getByteLength() > fragmentationThreshold && !isBroadcast(frame) && !frame->getReceiverAddress().isMulticast())
+        enqueueFragments(frame);
+    else
+        transmissionQueue.push_back(frame);
 
     handleWithFSM(frame);
 }
@@ -389,10 +437,18 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
         FSMA_State(DEFER)
         {
             FSMA_Enter(sendDownPendingRadioConfigMsg());
+            FSMA_Event_Transition(Backoff,
+                                  isMediumStateChange(msg) && isMediumFree() && backoff,
+                                  BACKOFF,
+            ;);
             FSMA_Event_Transition(Wait-DIFS,
                                   isMediumStateChange(msg) && isMediumFree(),
                                   WAITDIFS,
             ;);
+            FSMA_No_Event_Transition(Immediate-Backoff,
+                                     isMediumFree() && backoff,
+                                     BACKOFF,
+            ;);
             FSMA_No_Event_Transition(Immediate-Wait-DIFS,
                                      isMediumFree() || !backoff,
                                      WAITDIFS,
@@ -404,7 +460,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
         }
         FSMA_State(WAITDIFS)
         {
-            FSMA_Enter(scheduleDIFSPeriod());
+            FSMA_Enter(aggregateCurrentTransmission(); scheduleDIFSPeriod());
             FSMA_Event_Transition(Immediate-Transmit-RTS,
                                   msg == endDIFS && !isBroadcast(getCurrentTransmission())
                                   && getCurrentTransmission()->getByteLength() >= rtsThreshold && !backoff,
@@ -424,13 +480,6 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                 sendDataFrame(getCurrentTransmission());
                 cancelDIFSPeriod();
             );
-            FSMA_Event_Transition(DIFS-Over,
-                                  msg == endDIFS,
-                                  BACKOFF,
-                ASSERT(backoff);
-                if (isInvalidBackoffPeriod())
-                    generateBackoffPeriod();
-            );
             FSMA_Event_Transition(Busy,
                                   isMediumStateChange(msg) && !isMediumFree(),
                                   DEFER,
@@ -452,7 +501,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
         }
         FSMA_State(BACKOFF)
         {
-            FSMA_Enter(scheduleBackoffPeriod());
+            FSMA_Enter(aggregateCurrentTransmission(); scheduleBackoffPeriod());
             FSMA_Event_Transition(Transmit-RTS,
                                   msg == endBackoff && !isBroadcast(getCurrentTransmission())
                                   && getCurrentTransmission()->getByteLength() >= rtsThreshold,
@@ -475,10 +524,26 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                 cancelBackoffPeriod();
                 decreaseBackoffPeriod();
             );
+            // the DIFS period is part of this state, see WAITDIFS
+            FSMA_Event_Transition(Receive,
+                                  isLowerMsg(msg),
+                                  RECEIVE,
+                cancelBackoffPeriod();
+                decreaseBackoffPeriod();
+            );
         }
         FSMA_State(WAITACK)
         {
             FSMA_Enter(scheduleDataTimeoutPeriod(getCurrentTransmission()));
+            // the next fragment of the frame is sent after SIFS, see spec 9.2.5.7
+            FSMA_Event_Transition(Receive-ACK-More-Fragments,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_ACK && getCurrentTransmission()->getMoreFragments(),
+                                  WAITSIFS,
+                if (retryCounter == 0) numSentWithoutRetry++;
+                numSent++;
+                cancelTimeoutPeriod();
+                finishCurrentTransmission();
+            );
             FSMA_Event_Transition(Receive-ACK,
                                   isLowerMsg(msg) && isForUs(frame) && frameType == ST_ACK,
                                   IDLE,
@@ -543,6 +608,11 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   WAITACK,
                 sendDataFrameOnEndSIFS(getCurrentTransmission());
             );
+            FSMA_Event_Transition(Transmit-Next-Fragment,
+                                  msg == endSIFS && getFrameReceivedBeforeSIFS()->getType() == ST_ACK,
+                                  WAITACK,
+                sendDataFrameOnEndSIFS(getCurrentTransmission());
+            );
             FSMA_Event_Transition(Transmit-ACK,
                                   msg == endSIFS && isDataOrMgmtFrame(getFrameReceivedBeforeSIFS()),
                                   IDLE,
@@ -570,7 +640,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_No_Event_Transition(Immediate-Receive-Data,
                                      isLowerMsg(msg) && isForUs(frame) && isDataOrMgmtFrame(frame),
                                      WAITSIFS,
-                sendUp(frame);
+                sendUpDataFrame(check_and_cast<Ieee80211DataOrMgmtFrame *>(frame));
                 numReceived++;
             );
             FSMA_No_Event_Transition(Immediate-Receive-RTS,
@@ -652,7 +722,7 @@ void Ieee80211Mac::scheduleSIFSPeriod(Ieee80211Frame *frame)
 {
     EV << "scheduling SIFS period\n";
     endSIFS->setContextPointer(frame->dup());
-    scheduleAt(simTime() + getSIFS(), endSIFS);
+    scheduleTimer(endSIFS, simTime() + getSIFS());
 }
 
 void Ieee80211Mac::scheduleDIFSPeriod()
@@ -660,42 +730,42 @@ void Ieee80211Mac::scheduleDIFSPeriod()
     if (lastReceiveFailed)
     {
         EV << "receiption of last frame failed, scheduling EIFS period\n";
-        scheduleAt(simTime() + getEIFS(), endDIFS);
+        scheduleTimer(endDIFS, simTime() + getEIFS());
     }
     else
     {
         EV << "scheduling DIFS period\n";
-        scheduleAt(simTime() + getDIFS(), endDIFS);
+        scheduleTimer(endDIFS, simTime() + getDIFS());
     }
 }
 
 void Ieee80211Mac::cancelDIFSPeriod()
 {
     EV << "cancelling DIFS period\n";
-    cancelEvent(endDIFS);
+    cancelTimer(endDIFS);
 }
 
 void Ieee80211Mac::scheduleDataTimeoutPeriod(Ieee80211DataOrMgmtFrame *frameToSend)
 {
     EV << "scheduling data timeout period\n";
-    scheduleAt(simTime() + computeFrameDuration(frameToSend) + getSIFS() + computeFrameDuration(LENGTH_ACK, basicBitrate) + MAX_PROPAGATION_DELAY * 2, endTimeout);
+    scheduleTimer(endTimeout, simTime() + computeFrameDuration(frameToSend) + getSIFS() + computeFrameDuration(LENGTH_ACK, basicBitrate) + MAX_PROPAGATION_DELAY * 2);
 }
 
 void Ieee80211Mac::scheduleBroadcastTimeoutPeriod(Ieee80211DataOrMgmtFrame *frameToSend)
 {
     EV << "scheduling broadcast timeout period\n";
-    scheduleAt(simTime() + computeFrameDuration(frameToSend), endTimeout);
+    scheduleTimer(endTimeout, simTime() + computeFrameDuration(frameToSend));
 }
 
 void Ieee80211Mac::cancelTimeoutPeriod()
 {
     EV << "cancelling timeout period\n";
-    cancelEvent(endTimeout);
+    cancelTimer(endTimeout);
 }
 
 void Ieee80211Mac::scheduleCTSTimeoutPeriod()
 {
-    scheduleAt(simTime() + computeFrameDuration(LENGTH_RTS, basicBitrate) + getSIFS() + computeFrameDuration(LENGTH_CTS, basicBitrate) + MAX_PROPAGATION_DELAY * 2, endTimeout);
+    scheduleTimer(endTimeout, simTime() + computeFrameDuration(LENGTH_RTS, basicBitrate) + getSIFS() + computeFrameDuration(LENGTH_CTS, basicBitrate) + MAX_PROPAGATION_DELAY * 2);
 }
 
 void Ieee80211Mac::scheduleReservePeriod(Ieee80211Frame *frame)
@@ -705,19 +775,19 @@ void Ieee80211Mac::scheduleReservePeriod(Ieee80211Frame *frame)
     // see spec. 7.1.3.2
     if (!isForUs(frame) && reserve != 0 && reserve < 32768)
     {
-        if (endReserve->isScheduled()) {
-            simtime_t oldReserve = endReserve->getArrivalTime() - simTime();
+        if (isTimerScheduled(endReserve)) {
+            simtime_t oldReserve = getTimerDeadline(endReserve) - simTime();
 
             if (oldReserve > reserve)
                 return;
 
             reserve = std::max(reserve, oldReserve);
-            cancelEvent(endReserve);
+            cancelTimer(endReserve);
         }
         else if (radioState == RadioState::IDLE)
         {
             // NAV: the channel just became virtually busy according to the spec
-            scheduleAt(simTime(), mediumStateChange);
+            scheduleTimer(mediumStateChange, simTime());
         }
 
         EV << "scheduling reserve period for: " << reserve << endl;
@@ -725,7 +795,7 @@ void Ieee80211Mac::scheduleReservePeriod(Ieee80211Frame *frame)
         ASSERT(reserve > 0);
 
         nav = true;
-        scheduleAt(simTime() + reserve, endReserve);
+        scheduleTimer(endReserve, simTime() + reserve);
     }
 }
 
@@ -748,23 +818,90 @@ void Ieee80211Mac::generateBackoffPeriod()
 
 void Ieee80211Mac::decreaseBackoffPeriod()
 {
-    // see spec 9.2.5.2
-    simtime_t elapsedBackoffTime = simTime() - endBackoff->getSendingTime();
-    backoffPeriod -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
+    // see spec 9.2.5.2; nothing is counted down if the medium became busy during DIFS
+    simtime_t elapsedBackoffTime = simTime() - backoffStart;
+    if (elapsedBackoffTime > 0)
+        backoffPeriod -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
     ASSERT(backoffPeriod >= 0);
     EV << "backoff period decreased to " << backoffPeriod << endl;
 }
 
 void Ieee80211Mac::scheduleBackoffPeriod()
 {
-    EV << "scheduling backoff period\n";
-    scheduleAt(simTime() + backoffPeriod, endBackoff);
+    if (isInvalidBackoffPeriod())
+        generateBackoffPeriod();
+
+    // DIFS (or EIFS) and the backoff slots are waited for in one step
+    backoffStart = simTime() + (lastReceiveFailed ? getEIFS() : getDIFS());
+    EV << "scheduling backoff period, counting down from " << backoffStart << endl;
+    scheduleTimer(endBackoff, backoffStart + backoffPeriod);
 }
 
 void Ieee80211Mac::cancelBackoffPeriod()
 {
     EV << "cancelling Backoff period\n";
-    cancelEvent(endBackoff);
+    cancelTimer(endBackoff);
+}
+
+/****************************************************************
+ * Timer table functions.
+ */
+void Ieee80211Mac::scheduleTimer(cMessage *timer, simtime_t deadline)
+{
+    if (isTimerScheduled(timer))
+        error("timer %s is already scheduled", timer->getName());
+    timerDeadlines[timer->getKind()] = deadline;
+    timerSequenceNumbers[timer->getKind()] = timerSequenceNumber++;
+    rescheduleDeadlineTimer();
+}
+
+void Ieee80211Mac::cancelTimer(cMessage *timer)
+{
+    if (!isTimerScheduled(timer))
+        return;
+    timerDeadlines[timer->getKind()] = -1;
+    rescheduleDeadlineTimer();
+}
+
+cMessage *Ieee80211Mac::getNextTimer()
+{
+    // like in the future event set, timers with the same deadline expire in scheduling order
+    int next = -1;
+    for (int i = 0; i < NUM_TIMERS; i++)
+        if (timerDeadlines[i] >= 0 && (next == -1 || timerDeadlines[i] < timerDeadlines[next] ||
+            (timerDeadlines[i] == timerDeadlines[next] && timerSequenceNumbers[i] < timerSequenceNumbers[next])))
+            next = i;
+    return next == -1 ? NULL : timers[next];
+}
+
+void Ieee80211Mac::rescheduleDeadlineTimer()
+{
+    cMessage *next = getNextTimer();
+    if (!next)
+    {
+        cancelEvent(deadlineTimer);
+        return;
+    }
+    simtime_t deadline = getTimerDeadline(next);
+    if (deadlineTimer->isScheduled())
+    {
+        if (deadlineTimer->getArrivalTime() == deadline)
+            return;
+        cancelEvent(deadlineTimer);
+    }
+    scheduleAt(deadline, deadlineTimer);
+}
+
+void Ieee80211Mac::handleDeadlineTimer()
+{
+    // one timer per event, so that other events at the same time can come in
+    // between; their order relative to the timers may still differ from
+    // scheduling the timers directly, see the header
+    cMessage *timer = getNextTimer();
+    ASSERT(timer && getTimerDeadline(timer) == simTime());
+    timerDeadlines[timer->getKind()] = -1;
+    rescheduleDeadlineTimer();
+    handleSelfMsg(timer);
 }
 
 /****************************************************************
@@ -804,6 +941,67 @@ void Ieee80211Mac::sendBroadcastFrame(Ieee80211DataOrMgmtFrame *frameToSend)
     sendDown(buildBroadcastFrame(frameToSend));
 }
 
+void Ieee80211Mac::sendUpDataFrame(Ieee80211DataOrMgmtFrame *frame)
+{
+    Ieee80211AggregateFrame *aggregate = dynamic_cast<Ieee80211AggregateFrame *>(frame);
+    if (aggregate)
+    {
+        // the aggregate itself is deleted by handleLowerMsg()
+        EV << "passing up the " << aggregate->getNumSubframes() << " frames of the aggregate frame\n";
+        while (Ieee80211DataFrame *subframe = aggregate->removeFirstSubframe())
+            sendUp(subframe);
+        return;
+    }
+
+    if (frame->getFragmentNumber() == 0 && !frame->getMoreFragments())
+    {
+        sendUp(frame);
+        return;
+    }
+
+    // fragments arrive in order, as the next one is only sent after the previous one
+    // was acknowledged; a repeated fragment means that our ACK was lost
+    const MACAddress& transmitter = frame->getTransmitterAddress();
+    int fragmentNumber = frame->getFragmentNumber();
+    DefragmentationMap::iterator it = defragmentation.find(transmitter);
+    if (fragmentNumber == 0)
+    {
+        DefragmentationState& state = defragmentation[transmitter];
+        state.sequenceNumber = frame->getSequenceNumber();
+        state.nextFragmentNumber = 1;
+        state.totalLength = frame->getByteLength();
+        return;
+    }
+    if (it == defragmentation.end() || it->second.sequenceNumber != frame->getSequenceNumber() || fragmentNumber > it->second.nextFragmentNumber)
+    {
+        EV << "fragment #" << fragmentNumber << " does not continue a frame being received, dropping it\n";
+        if (it != defragmentation.end() && it->second.sequenceNumber == frame->getSequenceNumber())
+            defragmentation.erase(it);
+        return;
+    }
+    DefragmentationState& state = it->second;
+    if (fragmentNumber < state.nextFragmentNumber)
+    {
+        EV << "fragment #" << fragmentNumber << " already received\n";
+        return;
+    }
+    state.nextFragmentNumber++;
+    state.totalLength += frame->getByteLength();
+    if (frame->getMoreFragments())
+        return;
+
+    // The last fragment carries the encapsulated packet of the original frame;
+    // all fragments have the same header, so the length of the original frame
+    // is the header plus the packet.
+    long payloadLength = frame->getEncapsulatedPacket() ? frame->getEncapsulatedPacket()->getByteLength() : 0;
+    long headerLength = (state.totalLength - payloadLength) / state.nextFragmentNumber;
+    defragmentation.erase(it);
+    EV << "last fragment received, passing up the reassembled frame\n";
+    frame->setByteLength(headerLength + payloadLength);
+    frame->setFragmentNumber(0);
+    sendUp(frame);
+}
+
 void Ieee80211Mac::sendRTSFrame(Ieee80211DataOrMgmtFrame *frameToSend)
 {
     EV << "sending RTS frame\n";
@@ -836,8 +1034,12 @@ Ieee80211DataOrMgmtFrame *Ieee80211Mac::buildDataFrame(Ieee80211DataOrMgmtFrame
     else if (!frameToSend->getMoreFragments())
         frame->setDuration(getSIFS() + computeFrameDuration(LENGTH_ACK, basicBitrate));
     else
-        // FIXME: shouldn't we use the next frame to be sent?
-        frame->setDuration(3 * getSIFS() + 2 * computeFrameDuration(LENGTH_ACK, basicBitrate) + computeFrameDuration(frameToSend));
+    {
+        // the medium is reserved until the ACK of the next fragment, see spec 9.2.5.7
+        Ieee80211DataOrMgmtFrameList::iterator next = ++transmissionQueue.begin();
+        ASSERT(frameToSend == getCurrentTransmission() && next != transmissionQueue.end());
+        frame->setDuration(3 * getSIFS() + 2 * computeFrameDuration(LENGTH_ACK, basicBitrate) + computeFrameDuration(*next));
+    }
 
     return frame;
 }
@@ -903,7 +1105,14 @@ void Ieee80211Mac::finishCurrentTransmission()
 
 void Ieee80211Mac::giveUpCurrentTransmission()
 {
+    // the remaining fragments of the frame are useless without this one
+    bool moreFragments = getCurrentTransmission()->getMoreFragments();
     popTransmissionQueue();
+    while (moreFragments)
+    {
+        moreFragments = getCurrentTransmission()->getMoreFragments();
+        popTransmissionQueue();
+    }
     resetStateVariables();
     numGivenUp++;
 }
@@ -961,7 +1170,7 @@ bool Ieee80211Mac::isMediumStateChange(cMessage *msg)
 
 bool Ieee80211Mac::isMediumFree()
 {
-    return radioState == RadioState::IDLE && !endReserve->isScheduled();
+    return radioState == RadioState::IDLE && !isTimerScheduled(endReserve);
 }
 
 bool Ieee80211Mac::isBroadcast(Ieee80211Frame *frame)
@@ -988,10 +1197,12 @@ void Ieee80211Mac::popTransmissionQueue()
 {
     EV << "dropping frame from transmission queue\n";
     Ieee80211Frame *temp = transmissionQueue.front();
+    bool lastFragment = !temp->getMoreFragments();
     transmissionQueue.pop_front();
     delete temp;
 
-    if (queueModule)
+    // the queue module gave us one frame for all of its fragments
+    if (queueModule && lastFragment)
     {
         // tell queue module that we've become idle
         EV << "requesting another frame from queue module\n";
@@ -999,6 +1210,104 @@ void Ieee80211Mac::popTransmissionQueue()
     }
 }
 
+void Ieee80211Mac::enqueueFragments(Ieee80211DataOrMgmtFrame *frame)
+{
+    // The fragments are copies of the frame header with the length of a part
+    // of the payload; the last fragment is the frame itself, with the
+    // encapsulated packet. See sendUpDataFrame() for the reassembly.
+    cPacket *payload = frame->getEncapsulatedPacket();
+    long length = frame->getByteLength();
+    long headerLength = length - (payload ? payload->getByteLength() : 0);
+    long fragmentPayloadLength = fragmentationThreshold - headerLength;
+    if (fragmentPayloadLength <= 0)
+        error("frame (%s)%s cannot be fragmented: its header is longer than fragmentationThreshold=%d bytes",
+              frame->getClassName(), frame->getName(), fragmentationThreshold);
+    long numFragments = (length - headerLength + fragmentPayloadLength - 1) / fragmentPayloadLength;
+    if (numFragments > MAX_NUM_FRAGMENTS)
+        error("frame (%s)%s of %ld bytes would need %ld fragments, more than the allowed %d (increase fragmentationThreshold)",
+              frame->getClassName(), frame->getName(), length, numFragments, MAX_NUM_FRAGMENTS);
+
+    EV << "sending frame " << frame << " in " << numFragments << " fragments\n";
+    numFragmented++;
+    for (int i = 0; i < numFragments - 1; i++)
+    {
+        Ieee80211DataOrMgmtFrame *fragment = frame->dup();
+        delete fragment->decapsulate();
+        fragment->setByteLength(headerLength + fragmentPayloadLength);
+        fragment->setFragmentNumber(i);
+        fragment->setMoreFragments(true);
+        transmissionQueue.push_back(fragment);
+    }
+    frame->setByteLength(length - (numFragments - 1) * fragmentPayloadLength);
+    frame->setFragmentNumber(numFragments - 1);
+    frame->setMoreFragments(false);
+    transmissionQueue.push_back(frame);
+}
+
+bool Ieee80211Mac::isAggregatable(Ieee80211DataOrMgmtFrame *frame)
+{
+    return dynamic_cast<Ieee80211DataFrame *>(frame) && !dynamic_cast<Ieee80211AggregateFrame *>(frame) &&
+           !isBroadcast(frame) && !frame->getReceiverAddress().isMulticast() &&
+           frame->getFragmentNumber() == 0 && !frame->getMoreFragments() && !frame->getRetry();
+}
+
+void Ieee80211Mac::aggregateCurrentTransmission()
+{
+    if (maxAggregateFrames <= 1 || transmissionQueue.size() < 2)
+        return;
+
+    Ieee80211DataOrMgmtFrame *first = getCurrentTransmission();
+    Ieee80211AggregateFrame *aggregate = dynamic_cast<Ieee80211AggregateFrame *>(first);
+    if (aggregate ? aggregate->getRetry() : !isAggregatable(first))
+        return;
+
+    // frames are taken in queue order, up to the first one that cannot be added
+    Ieee80211DataOrMgmtFrameList::iterator it = ++transmissionQueue.begin();
+    long length = first->getByteLength();
+    int numFrames = aggregate ? aggregate->getNumSubframes() : 1;
+    while (it != transmissionQueue.end() && numFrames < maxAggregateFrames)
+    {
+        Ieee80211DataOrMgmtFrame *frame = *it;
+        if (!isAggregatable(frame) || frame->getReceiverAddress() != first->getReceiverAddress())
+            break;
+        long subframeLength = AMSDU_SUBFRAME_HEADER_BYTES + frame->getByteLength() - DATA_FRAME_HEADER_BYTES;
+        if (!aggregate)
+            subframeLength += AMSDU_SUBFRAME_HEADER_BYTES;  // the first frame becomes a subframe too
+        if (length + subframeLength > maxAggregateLength)
+            break;
+
+        if (!aggregate)
+        {
+            // the aggregate takes over the header of the first frame
+            Ieee80211DataFrame *firstDataFrame = check_and_cast<Ieee80211DataFrame *>(first);
+            aggregate = new Ieee80211AggregateFrame("wlan-amsdu");
+            aggregate->setToDS(firstDataFrame->getToDS());
+            aggregate->setFromDS(firstDataFrame->getFromDS());
+            aggregate->setReceiverAddress(firstDataFrame->getReceiverAddress());
+            aggregate->setTransmitterAddress(firstDataFrame->getTransmitterAddress());
+            aggregate->setAddress3(firstDataFrame->getAddress3());
+            aggregate->setAddress4(firstDataFrame->getAddress4());
+            aggregate->setSequenceNumber(firstDataFrame->getSequenceNumber());
+            aggregate->addSubframe(firstDataFrame);
+            transmissionQueue.front() = aggregate;
+            numSentAggregates++;
+            numAggregatedFrames++;
+        }
+        aggregate->addSubframe(check_and_cast<Ieee80211DataFrame *>(frame));
+        it = transmissionQueue.erase(it);
+        length = aggregate->getByteLength();
+        numFrames++;
+        numAggregatedFrames++;
+
+        // the frame has left the queue as if it had been sent
+        if (queueModule)
+            queueModule->requestPacket();
+    }
+
+    if (aggregate)
+        EV << "current transmission is an aggregate of " << aggregate->getNumSubframes() << " frames, " << length << " bytes\n";
+}
+
 double Ieee80211Mac::computeFrameDuration(Ieee80211Frame *msg)
 {
     return computeFrameDuration(msg->getBitLength(), bitrate);
@@ -22,9 +22,11 @@
 #define FSM_DEBUG
 
 #include <list>
+#include <map>
 #include "WirelessMacBase.h"
 #include "IPassiveQueue.h"
 #include "Ieee80211Frame_m.h"
+#include "Ieee80211AggregateFrame.h"
 #include "Ieee80211Consts.h"
 #include "NotificationBoard.h"
 #include "RadioState.h"
@@ -39,7 +41,6 @@
  *
  * For more info, see the NED file.
  *
- * TODO: support fragmentation
  * TODO: PCF mode
  * TODO: CF period
  * TODO: pass radio power to upper layer
@@ -67,6 +68,23 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
 
   typedef std::list<Ieee80211ASFTuple*> Ieee80211ASFTupleList;
 
+  /**
+   * Fragments received so far of a fragmented frame from a transmitter.
+   */
+  struct DefragmentationState
+  {
+      int sequenceNumber;
+      int nextFragmentNumber;
+      long totalLength;  // of the fragments received, in bytes
+  };
+
+  struct MACAddressCompare
+  {
+      bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
+  };
+
+  typedef std::map<MACAddress, DefragmentationState, MACAddressCompare> DefragmentationMap;
+
   protected:
     /**
      * @name Configuration parameters
@@ -82,7 +100,11 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     /** The basic bitrate (1 or 2 Mbps) is used to transmit control frames */
     double basicBitrate;
 
-    /** Maximum number of frames in the queue; should be set in the omnetpp.ini */
+    /**
+     * Maximum number of frames in the queue; should be set in the omnetpp.ini.
+     * Each fragment counts as a frame, and a frame is only dropped if the
+     * queue is already full when it arrives.
+     */
     int maxQueueSize;
 
     /**
@@ -111,7 +133,16 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     int cwMinBroadcast;
 
     /** Messages longer than this threshold will be sent in multiple fragments. see spec 361 */
-    static const int fragmentationThreshold = 2346;
+    int fragmentationThreshold;
+
+    /**
+     * Maximum number of data frames for the same receiver that are sent
+     * together in an aggregate frame (A-MSDU); 1 means no aggregation.
+     */
+    int maxAggregateFrames;
+
+    /** Maximum length of an aggregate frame in bytes */
+    int maxAggregateLength;
     //@}
 
   public:
@@ -164,6 +195,12 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     /** Remaining backoff period in seconds */
     simtime_t backoffPeriod;
 
+    /**
+     * When the countdown of backoffPeriod starts or started, i.e. the end of
+     * the DIFS (or EIFS) period in BACKOFF state. The slots are counted from here.
+     */
+    simtime_t backoffStart;
+
     /**
      * Number of frame retransmission attempts, this is a simpification of
      * SLRC and SSRC, see 9.2.4 in the spec
@@ -183,6 +220,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
      */
     Ieee80211ASFTupleList asfTuplesList;
 
+    /** Fragmented frames being received, by transmitter address */
+    DefragmentationMap defragmentation;
+
     /** Passive queue module to request messages from */
     IPassiveQueue *queueModule;
 
@@ -194,8 +234,44 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     //@}
 
   protected:
-    /** @name Timer messages */
+    /**
+     * @name Timer messages
+     * The timer messages are never scheduled themselves. Their deadlines are
+     * kept in timerDeadlines, and only the earliest one is scheduled, with
+     * deadlineTimer; when it expires, the timer message is processed as if it
+     * had been scheduled. This way, setting and cancelling a timer that is not
+     * the next one to expire does not touch the future event set.
+     *
+     * Timers with the same deadline expire in the order they were scheduled,
+     * but the order relative to other events at the same simulation time may
+     * differ from scheduling the timers directly (deadlineTimer is inserted
+     * into the future event set when it is rescheduled, not when the timer
+     * was set), so fingerprints can change.
+     */
     //@{
+    enum TimerKind {
+        TIMER_SIFS,
+        TIMER_DIFS,
+        TIMER_BACKOFF,
+        TIMER_TIMEOUT,
+        TIMER_RESERVE,
+        TIMER_MEDIUMSTATECHANGE,
+        NUM_TIMERS
+    };
+
+    /** The timer messages below, indexed by message kind */
+    cMessage *timers[NUM_TIMERS];
+
+    /** Deadlines of the timers, -1 if not scheduled */
+    simtime_t timerDeadlines[NUM_TIMERS];
+
+    /** Order in which the timers were scheduled, for timers with the same deadline */
+    long timerSequenceNumbers[NUM_TIMERS];
+    long timerSequenceNumber;
+
+    /** The single self message of the MAC, scheduled for the earliest timer deadline */
+    cMessage *deadlineTimer;
+
     /** End of the Short Inter-Frame Time period */
     cMessage *endSIFS;
 
@@ -215,6 +291,27 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     cMessage *mediumStateChange;
     //@}
 
+  protected:
+    /**
+     * @name Timer table functions
+     * These replace scheduleAt(), cancelEvent() etc. for the timer messages above.
+     */
+    //@{
+    virtual void scheduleTimer(cMessage *timer, simtime_t deadline);
+    virtual void cancelTimer(cMessage *timer);
+    bool isTimerScheduled(cMessage *timer) {return timerDeadlines[timer->getKind()] >= 0;}
+    simtime_t getTimerDeadline(cMessage *timer) {return timerDeadlines[timer->getKind()];}
+
+    /** Returns the timer that expires first, or NULL if none is scheduled */
+    virtual cMessage *getNextTimer();
+
+    /** Schedules deadlineTimer for the deadline of getNextTimer(), if needed */
+    virtual void rescheduleDeadlineTimer();
+
+    /** Called when deadlineTimer expires: processes the timer that is due */
+    virtual void handleDeadlineTimer();
+    //@}
+
   protected:
     /** @name Statistics */
     //@{
@@ -226,6 +323,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     long numReceived;
     long numSentBroadcast;
     long numReceivedBroadcast;
+    long numSentAggregates;
+    long numAggregatedFrames;
+    long numFragmented;
     cOutVector stateVector;
     cOutVector radioStateVector;
     //@}
@@ -249,6 +349,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void initialize(int);
     virtual void registerInterface();
     virtual void initializeQueueModule();
+    virtual void finish();
     //@}
 
   protected:
@@ -314,7 +415,18 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void invalidateBackoffPeriod();
     virtual bool isInvalidBackoffPeriod();
     virtual void generateBackoffPeriod();
+
+    /**
+     * @brief Subtracts the whole slots elapsed since backoffStart from the
+     * backoff period, when the countdown is interrupted.
+     */
     virtual void decreaseBackoffPeriod();
+
+    /**
+     * @brief Schedules the backoff timer for the end of DIFS (or EIFS) plus
+     * the remaining backoff period in one step, and sets backoffStart to the
+     * end of DIFS.
+     */
     virtual void scheduleBackoffPeriod();
     virtual void cancelBackoffPeriod();
     //@}
@@ -332,6 +444,13 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void sendDataFrameOnEndSIFS(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendBroadcastFrame(Ieee80211DataOrMgmtFrame *frameToSend);
+
+    /**
+     * Sends up a unicast data or management frame received from the
+     * physical layer. Aggregates are split into their subframes, and
+     * fragments are only passed up when the last fragment has arrived.
+     */
+    virtual void sendUpDataFrame(Ieee80211DataOrMgmtFrame *frame);
     //@}
 
   protected:
@@ -395,6 +514,20 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     /** @brief Deletes frame at the front of queue. */
     virtual void popTransmissionQueue();
 
+    /** @brief Splits the frame into fragments of at most fragmentationThreshold bytes, and queues them. */
+    virtual void enqueueFragments(Ieee80211DataOrMgmtFrame *frame);
+
+    /** @brief Returns true if the frame may be sent in an aggregate frame. */
+    virtual bool isAggregatable(Ieee80211DataOrMgmtFrame *frame);
+
+    /**
+     * @brief Moves the data frames that follow the current transmission in the
+     * queue and are for the same receiver into an aggregate frame, which then
+     * becomes the current transmission. Does nothing if the current
+     * transmission has already been attempted.
+     */
+    virtual void aggregateCurrentTransmission();
+
     /**
      * @brief Computes the duration (in seconds) of the transmission of a frame
      * over the physical channel. 'bits' should be the total length of the MAC frame
@@ -31,6 +31,17 @@ static std::ostream& operator<< (std::ostream& os, const Ieee80211MgmtAP::STAInf
     return os;
 }
 
+static std::ostream& operator<< (std::ostream& os, const Ieee80211MgmtAP::STAList& staList)
+{
+    // the hash table cannot be inspected entry by entry like a std::map
+    int numAssociated = 0;
+    for (Ieee80211MgmtAP::STAList::const_iterator it = staList.begin(); it != staList.end(); ++it)
+        if (it->second.status == Ieee80211MgmtAP::ASSOCIATED)
+            numAssociated++;
+    os << staList.size() << " STAs, " << numAssociated << " associated";
+    return os;
+}
+
 void Ieee80211MgmtAP::initialize(int stage)
 {
     Ieee80211MgmtAPBase::initialize(stage);
@@ -48,7 +59,7 @@ void Ieee80211MgmtAP::initialize(int stage)
         WATCH(channelNumber);
         WATCH(beaconInterval);
         WATCH(numAuthSteps);
-        WATCH_MAP(staList);
+        WATCH(staList);
 
         //TBD fill in supportedRates
 
@@ -19,7 +19,7 @@
 #define IEEE80211_MGMT_AP_H
 
 #include <omnetpp.h>
-#include <map>
+#include "INETHash.h"
 #include "Ieee80211MgmtAPBase.h"
 #include "NotificationBoard.h"
 
@@ -45,10 +45,7 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
         //double expiry;          //XXX association should expire after a while if STA is silent?
     };
 
-    struct MAC_compare {
-        bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
-    };
-    typedef std::map<MACAddress,STAInfo, MAC_compare> STAList;
+    typedef inet_hash::unordered_map<MACAddress,STAInfo,MACAddressHash> STAList;
 
   protected:
     // configuration
@@ -166,8 +166,12 @@ void Ieee80211MgmtSTA::handleTimer(cMessage *msg)
     }
     else if (msg->getKind()==MK_BEACON_TIMEOUT)
     {
-        // missed a few consecutive beacons
-        beaconLost();
+        // beacons only record their arrival time, so check if one came since the timer was scheduled
+        simtime_t timeout = assocAP.lastBeaconTime + MAX_BEACONS_MISSED*assocAP.beaconInterval;
+        if (timeout > simTime())
+            scheduleAt(timeout, msg);
+        else
+            beaconLost(); // missed a few consecutive beacons
     }
     else
     {
@@ -223,10 +227,8 @@ Ieee80211DataFrame *Ieee80211MgmtSTA::encapsulate(cPacket *msg)
 
 Ieee80211MgmtSTA::APInfo *Ieee80211MgmtSTA::lookupAP(const MACAddress& address)
 {
-    for (AccessPointList::iterator it=apList.begin(); it!=apList.end(); ++it)
-        if (it->address == address)
-            return &(*it);
-    return NULL;
+    AccessPointIndex::iterator it = apIndex.find(address);
+    return it==apIndex.end() ? NULL : it->second;
 }
 
 void Ieee80211MgmtSTA::clearAPList()
@@ -235,6 +237,7 @@ void Ieee80211MgmtSTA::clearAPList()
         if (it->authTimeoutMsg)
             delete cancelEvent(it->authTimeoutMsg);
     apList.clear();
+    apIndex.clear();
 }
 
 void Ieee80211MgmtSTA::changeChannel(int channelNum)
@@ -715,6 +718,7 @@ void Ieee80211MgmtSTA::handleAssociationResponseFrame(Ieee80211AssociationRespon
         nb->fireChangeNotification(NF_L2_ASSOCIATED, NULL); //XXX detail: InterfaceEntry?
 
         assocAP.beaconTimeoutMsg = new cMessage("beaconTimeout", MK_BEACON_TIMEOUT);
+        assocAP.lastBeaconTime = simTime();
         scheduleAt(simTime()+MAX_BEACONS_MISSED*assocAP.beaconInterval, assocAP.beaconTimeoutMsg);
     }
 
@@ -767,8 +771,9 @@ void Ieee80211MgmtSTA::handleBeaconFrame(Ieee80211BeaconFrame *frame)
     {
         EV << "Beacon is from associated AP, restarting beacon timeout timer\n";
         ASSERT(assocAP.beaconTimeoutMsg!=NULL);
-        cancelEvent(assocAP.beaconTimeoutMsg);
-        scheduleAt(simTime()+MAX_BEACONS_MISSED*assocAP.beaconInterval, assocAP.beaconTimeoutMsg);
+        assocAP.lastBeaconTime = simTime();
+        if (!assocAP.beaconTimeoutMsg->isScheduled())
+            scheduleAt(simTime()+MAX_BEACONS_MISSED*assocAP.beaconInterval, assocAP.beaconTimeoutMsg);
 
         //APInfo *ap = lookupAP(frame->getTransmitterAddress());
         //ASSERT(ap!=NULL);
@@ -801,11 +806,13 @@ void Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211Bea
         EV << "Inserting AP address=" << address << ", SSID=" << body.getSSID() << " into our AP list\n";
         apList.push_back(APInfo());
         ap = &apList.back();
+        ap->address = address;
+        apIndex[address] = ap;
     }
 
     ap->channel = body.getChannelNumber();
-    ap->address = address;
-    ap->ssid = body.getSSID();
+    if (ap->ssid != body.getSSID())  // usually unchanged, spare the copy
+        ap->ssid = body.getSSID();
     ap->supportedRates = body.getSupportedRates();
     ap->beaconInterval = body.getBeaconInterval();
 
@@ -19,6 +19,7 @@
 #define IEEE80211_MGMT_STA_H
 
 #include <omnetpp.h>
+#include "INETHash.h"
 #include "Ieee80211MgmtBase.h"
 #include "NotificationBoard.h"
 #include "Ieee80211Primitives_m.h"
@@ -78,8 +79,9 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     {
         int receiveSequence;
         cMessage *beaconTimeoutMsg;
+        simtime_t lastBeaconTime; // beaconTimeoutMsg is only moved when it expires
 
-        AssociatedAPInfo() : APInfo() {receiveSequence=0; beaconTimeoutMsg=NULL;}
+        AssociatedAPInfo() : APInfo() {receiveSequence=0; beaconTimeoutMsg=NULL; lastBeaconTime=0;}
     };
 
   protected:
@@ -97,6 +99,10 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     typedef std::list<APInfo> AccessPointList;
     AccessPointList apList;
 
+    // index of apList by AP address, so that beacons can be looked up in constant time
+    typedef inet_hash::unordered_map<MACAddress,APInfo*,MACAddressHash> AccessPointIndex;
+    AccessPointIndex apIndex;
+
     // associated Access Point
     bool isAssociated;
     cMessage *assocTimeoutMsg; // if non-NULL: association is in progress
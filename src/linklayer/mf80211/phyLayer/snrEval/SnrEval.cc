@@ -459,7 +459,7 @@ void SnrEval::changeChannel(int channel)
 
     rs.setChannelNumber(channel);
     cc->updateHostChannel(myHostRef, channel);
-    ChannelControl::TransmissionList tl = cc->getOngoingTransmissions(channel);
+    const ChannelControl::TransmissionList& tl = cc->getOngoingTransmissions(channel);
 
     // pick up ongoing transmissions on the new channel
     EV << "Picking up ongoing transmissions on new channel:\n";
@@ -467,7 +467,7 @@ void SnrEval::changeChannel(int channel)
     {
         AirFrame *frame = *it;
         // time for the message to reach us
-        double distance = myHostRef->pos.distance(frame->getSenderPos());
+        double distance = getMyPosition().distance(frame->getSenderPos());
         simtime_t propagationDelay = distance / LIGHT_SPEED;
 
         // if this transmission is on our new channel and it would reach us in the future, then schedule it
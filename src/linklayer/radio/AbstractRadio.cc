@@ -83,6 +83,12 @@ void AbstractRadio::initialize(int stage)
 
         radioModel = createRadioModel();
         radioModel->initializeFrom(this);
+
+        cacheReceivedPower = receptionModel->isDeterministic();
+        pruningThreshold = FWMath::dBm2mW(par("pruningThreshold"));
+        pruneWeakFrames = par("pruneWeakFrames");
+        if (pruneWeakFrames && !cacheReceivedPower)
+            error("pruneWeakFrames=true requires a deterministic reception model (e.g. no shadowing)");
     }
     else if (stage == 1)
     {
@@ -96,6 +102,11 @@ void AbstractRadio::initialize(int stage)
         // tell initial channel number to ChannelControl; should be done in
         // stage==2 or later, because base class initializes myHostRef in that stage
         cc->updateHostChannel(myHostRef, rs.getChannelNumber());
+
+        // the received power can also be calculated in advance at the sender
+        // (see ChannelControl's numThreads parameter) if it is cacheable
+        if (cacheReceivedPower)
+            cc->setHostReceptionFilter(myHostRef, this);
     }
 }
 
@@ -391,14 +402,7 @@ void AbstractRadio::handleSelfMsg(cMessage *msg)
 void AbstractRadio::handleLowerMsgStart(AirFrame * airframe)
 {
     // Calculate the receive power of the message
-
-    // calculate distance
-    const Coord& myPos = getMyPosition();
-    const Coord& framePos = airframe->getSenderPos();
-    double distance = myPos.distance(framePos);
-
-    // calculate receive power
-    double rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, distance);
+    double rcvdPower = getReceivedPower(airframe->getSenderModuleId(), airframe, getMyPosition());
 
     // store the receive power in the recvBuff
     recvBuff[airframe] = rcvdPower;
@@ -527,6 +531,73 @@ void AbstractRadio::handleLowerMsgEnd(AirFrame * airframe)
     }
 }
 
+// unlike Coord::operator==, exact: the cached value must be the same as a recalculated one
+static inline bool isSamePosition(const Coord& a, const Coord& b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+double AbstractRadio::getReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos)
+{
+    if (!cacheReceivedPower)
+        return receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, receiverPos.distance(airframe->getSenderPos()));
+
+    double rcvdPower = lookupReceivedPower(senderId, airframe, receiverPos);
+    if (rcvdPower < 0)
+    {
+        // not cached yet, or one of the hosts has moved since
+        rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, receiverPos.distance(airframe->getSenderPos()));
+        storeReceivedPower(senderId, airframe, receiverPos, rcvdPower);
+    }
+    return rcvdPower;
+}
+
+double AbstractRadio::lookupReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos) const
+{
+    ReceivedPowerKey key;
+    key.senderId = senderId;
+    key.pSend = airframe->getPSend();
+    key.channel = airframe->getChannelNumber();
+    ReceivedPowerCache::const_iterator it = receivedPowerCache.find(key);
+    if (it != receivedPowerCache.end() && isSamePosition(it->second.senderPos, airframe->getSenderPos()) && isSamePosition(it->second.receiverPos, receiverPos))
+        return it->second.rcvdPower;
+    return -1;
+}
+
+void AbstractRadio::storeReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos, double rcvdPower)
+{
+    ReceivedPowerKey key;
+    key.senderId = senderId;
+    key.pSend = airframe->getPSend();
+    key.channel = airframe->getChannelNumber();
+    ReceivedPowerEntry& entry = receivedPowerCache[key];
+    entry.senderPos = airframe->getSenderPos();
+    entry.receiverPos = receiverPos;
+    entry.rcvdPower = rcvdPower;
+}
+
+double AbstractRadio::calculateReceivedPower(cModule *srcRadioMod, AirFrame *airframe, const Coord& receiverPos)
+{
+    // NOTE: called from the sending radio, possibly on a worker thread, see IReceptionFilter
+    if (!cacheReceivedPower)
+        return -1;
+    double rcvdPower = lookupReceivedPower(srcRadioMod->getId(), airframe, receiverPos);
+    if (rcvdPower < 0)
+        rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, receiverPos.distance(airframe->getSenderPos()));
+    return rcvdPower;
+}
+
+bool AbstractRadio::isReceptionNeeded(cModule *srcRadioMod, AirFrame *airframe, const Coord& receiverPos, double rcvdPower)
+{
+    // NOTE: called from the sending radio, see IReceptionFilter; the power
+    // stored here is found by handleLowerMsgStart() if neither host moves
+    if (rcvdPower >= 0)
+        storeReceivedPower(srcRadioMod->getId(), airframe, receiverPos, rcvdPower);
+    if (!pruneWeakFrames)
+        return true;
+    return getReceivedPower(srcRadioMod->getId(), airframe, receiverPos) >= pruningThreshold;
+}
+
 void AbstractRadio::addNewSnr()
 {
     SnrListEntry listEntry;     // create a new entry
@@ -567,7 +638,7 @@ void AbstractRadio::changeChannel(int channel)
 
     rs.setChannelNumber(channel);
     cc->updateHostChannel(myHostRef, channel);
-    ChannelControl::TransmissionList tl = cc->getOngoingTransmissions(channel);
+    const ChannelControl::TransmissionList& tl = cc->getOngoingTransmissions(channel);
 
     cModule *myHost = findHost();
     cGate *radioGate = myHost->gate("radioIn");
@@ -578,7 +649,7 @@ void AbstractRadio::changeChannel(int channel)
     {
         AirFrame *airframe = *it;
         // time for the message to reach us
-        double distance = myHostRef->pos.distance(airframe->getSenderPos());
+        double distance = getMyPosition().distance(airframe->getSenderPos());
         simtime_t propagationDelay = distance / LIGHT_SPEED;
 
         // if this transmission is on our new channel and it would reach us in the future, then schedule it
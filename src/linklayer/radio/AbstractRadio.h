@@ -53,7 +53,7 @@
  *
  * @author Andras Varga, Levente Meszaros
  */
-class INET_API AbstractRadio : public ChannelAccess
+class INET_API AbstractRadio : public ChannelAccess, public IReceptionFilter
 {
   public:
     AbstractRadio();
@@ -98,6 +98,35 @@ class INET_API AbstractRadio : public ChannelAccess
     /** Returns the current channel the radio is tuned to */
     virtual int getChannelNumber() const {return rs.getChannelNumber();}
 
+    /**
+     * Returns the power the frame arrives with at receiverPos. senderId
+     * identifies the sending radio; if the reception model is deterministic,
+     * the result is cached until the sender or this host moves.
+     */
+    virtual double getReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos);
+
+    /** Returns the cached received power, or -1 if it is not in the cache */
+    double lookupReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos) const;
+
+    /** Stores the received power in the cache */
+    void storeReceivedPower(int senderId, AirFrame *airframe, const Coord& receiverPos, double rcvdPower);
+
+    /**
+     * IReceptionFilter method: returns the received power from the cache or
+     * the reception model, without changing the cache, as this may run on
+     * several threads. Returns -1 if the reception model is not deterministic.
+     */
+    virtual double calculateReceivedPower(cModule *srcRadioMod, AirFrame *airframe, const Coord& receiverPos);
+
+    /**
+     * IReceptionFilter method: stores the received power calculated in
+     * advance in the cache, and if the pruneWeakFrames parameter is true,
+     * returns false for frames that arrive with less power than
+     * pruningThreshold. Only registered with ChannelControl if the
+     * reception model is deterministic.
+     */
+    virtual bool isReceptionNeeded(cModule *srcRadioMod, AirFrame *airframe, const Coord& receiverPos, double rcvdPower);
+
     /** Updates the SNR information of the relevant AirFrame */
     virtual void addNewSnr();
 
@@ -176,6 +205,44 @@ class INET_API AbstractRadio : public ChannelAccess
      */
     RecvBuff recvBuff;
 
+    /** Identifies a transmission in the received power cache */
+    struct ReceivedPowerKey
+    {
+        int senderId;     ///< id of the sending radio module
+        double pSend;     ///< transmit power
+        int channel;      ///< channel number
+        bool operator<(const ReceivedPowerKey& other) const {
+            if (senderId != other.senderId) return senderId < other.senderId;
+            if (pSend != other.pSend) return pSend < other.pSend;
+            return channel < other.channel;
+        }
+    };
+
+    /** The received power, valid as long as neither host moves */
+    struct ReceivedPowerEntry
+    {
+        Coord senderPos;
+        Coord receiverPos;
+        double rcvdPower;
+    };
+
+    typedef std::map<ReceivedPowerKey, ReceivedPowerEntry> ReceivedPowerCache;
+
+    /** State: received power of the recent transmissions of other radios */
+    ReceivedPowerCache receivedPowerCache;
+
+    /** Configuration: whether receivedPowerCache is used (the reception model is deterministic) */
+    bool cacheReceivedPower;
+
+    /** Configuration: whether frames arriving with less than pruningThreshold are delivered at all */
+    bool pruneWeakFrames;
+
+    /**
+     * Configuration: frames arriving with less power (in mW) are not delivered
+     * at all if the pruneWeakFrames parameter is true.
+     */
+    double pruningThreshold;
+
     /** State: the current RadioState of the NIC; includes channel number */
     RadioState rs;
 
@@ -40,6 +40,13 @@ class INET_API IReceptionModel : public cPolymorphic
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance) = 0;
 
+    /**
+     * Should return true if calculateReceivedPower() always returns the same
+     * value for the same arguments and has no side effects, i.e. its result
+     * may be cached, or calculated in advance on another thread.
+     */
+    virtual bool isDeterministic() {return false;}
+
     /**
      * Virtual destructor.
      */
@@ -41,6 +41,11 @@ class INET_API PathLossReceptionModel : public IReceptionModel
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
 
+    /**
+     * Deterministic unless shadowing is enabled.
+     */
+    virtual bool isDeterministic() {return shadowingDeviation == 0.0;}
+
     /**
      * Convert mW to dBm.
     */
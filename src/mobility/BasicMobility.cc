@@ -21,6 +21,7 @@
 
 
 #include "BasicMobility.h"
+#include "MobilityScheduler.h"
 #include "FWMath.h"
 
 
@@ -36,6 +37,13 @@ static int parseInt(const char *s, int defaultValue)
 }
 
 
+BasicMobility::BasicMobility()
+{
+    scheduler = NULL;
+    scheduledUpdateMsg = NULL;
+    lazyPositions = false;
+}
+
 void BasicMobility::initialize(int stage)
 {
     BasicModule::initialize(stage);
@@ -49,6 +57,15 @@ void BasicMobility::initialize(int stage)
         // get a pointer to the host
         hostPtr = findHost();
         myHostRef = cc->registerHost(hostPtr, Coord());
+
+        // not all mobility models can compute their position analytically
+        lazyPositions = hasPar("lazyPositions") && par("lazyPositions").boolValue();
+
+        // with a MobilityScheduler, all hosts move at the scheduler's pace;
+        // subclasses read updateInterval after this
+        scheduler = MobilityScheduler::find();
+        if (scheduler && hasPar("updateInterval"))
+            par("updateInterval").setDoubleValue(SIMTIME_DBL(scheduler->getUpdateInterval()));
     }
     else if (stage == 1)
     {
@@ -81,6 +98,9 @@ void BasicMobility::initialize(int stage)
 
         // print new host position on the screen and update bb info
         updatePosition();
+
+        if (lazyPositions)
+            cc->setHostTrajectory(myHostRef, this);
     }
 }
 
@@ -92,10 +112,39 @@ void BasicMobility::handleMessage(cMessage * msg)
     handleSelfMsg(msg);
 }
 
+void BasicMobility::scheduleUpdate(simtime_t t, cMessage *msg)
+{
+    if (!scheduler)
+    {
+        scheduleAt(t, msg);
+        return;
+    }
+
+    if (scheduledUpdateMsg)
+        error("scheduleUpdate(): an update is already pending");
+    scheduledUpdateMsg = msg;
+    scheduler->scheduleUpdate(this);
+}
+
+void BasicMobility::handleScheduledUpdate()
+{
+    Enter_Method_Silent();
+    cMessage *msg = scheduledUpdateMsg;
+    if (!msg)
+        return;
+    scheduledUpdateMsg = NULL;
+    handleSelfMsg(msg);
+}
+
 
 void BasicMobility::updatePosition()
 {
-    cc->updateHostPosition(myHostRef, pos);
+    // during a scheduler tick, ChannelControl updates the connections
+    // of all hosts at the end of the tick
+    if (scheduler && scheduler->isUpdating())
+        cc->setHostPosition(myHostRef, pos);
+    else
+        cc->updateHostPosition(myHostRef, pos);
 
     if (ev.isGUI())
     {
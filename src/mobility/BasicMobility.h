@@ -28,7 +28,9 @@
 #include "BasicModule.h"
 #include "ChannelControl.h"
 #include "Coord.h"
+#include "ITrajectory.h"
 
+class MobilityScheduler;
 
 /**
  * @brief Abstract base class for all mobility modules.
@@ -42,11 +44,20 @@
  * Change notifications about position changes are also posted to
  * NotificationBoard.
  *
+ * Subclasses should schedule their periodic position updates with
+ * scheduleUpdate() instead of scheduleAt(), so that a MobilityScheduler
+ * (if present in the network) can move all hosts in one event.
+ *
+ * Models whose movement can be computed analytically may support the
+ * "lazyPositions" parameter: if it is set, they redefine getPositionAt(),
+ * only schedule events at the ends of the segments of their trajectory,
+ * and ChannelControl computes their position when it is needed.
+ *
  * @ingroup mobility
  * @ingroup basicModules
  * @author Daniel Willkomm, Andras Varga
  */
-class INET_API BasicMobility : public BasicModule
+class INET_API BasicMobility : public BasicModule, public ITrajectory
 {
   public:
     /**
@@ -73,6 +84,15 @@ class INET_API BasicMobility : public BasicModule
     /** @brief Stores the actual position of the host*/
     Coord pos;
 
+    /** @brief If true, the position is evaluated on demand via getPositionAt() */
+    bool lazyPositions;
+
+    /** @brief The MobilityScheduler of the network, or NULL if there is none */
+    MobilityScheduler *scheduler;
+
+    /** @brief The message passed to scheduleUpdate(), while it is pending at the scheduler */
+    cMessage *scheduledUpdateMsg;
+
   protected:
     /** @brief This modules should only receive self-messages*/
     virtual void handleMessage(cMessage *msg);
@@ -87,6 +107,14 @@ class INET_API BasicMobility : public BasicModule
     /** @brief Called upon arrival of a self messages*/
     virtual void handleSelfMsg(cMessage *msg) = 0;
 
+    /** @brief Schedules a periodic position update.
+     *
+     * Without a MobilityScheduler, this is the same as scheduleAt(t, msg).
+     * Otherwise msg is kept here, and handleSelfMsg() is called with it at
+     * the next tick of the scheduler, whatever t is.
+     */
+    virtual void scheduleUpdate(simtime_t t, cMessage *msg);
+
     /** @brief Update the position information for this node.
      *
      * This function tells NotificationBoard that the position has changed, and
@@ -140,6 +168,14 @@ class INET_API BasicMobility : public BasicModule
      */
     virtual void handleIfOutside(BorderPolicy policy, Coord& targetPos, Coord& step, double& angle);
 
+  public:
+    BasicMobility();
+
+    /** @brief Called by the MobilityScheduler to perform the update requested with scheduleUpdate() */
+    virtual void handleScheduledUpdate();
+
+    /** @brief Returns the position at time t; the default implementation returns pos */
+    virtual Coord getPositionAt(simtime_t t) {return pos;}
 };
 
 #endif
@@ -17,14 +17,33 @@
 
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <process.h>  // getpid()
+#else
+#include <unistd.h>   // getpid()
+#endif
 #include "BonnMotionFileCache.h"
 
+// binary format: magic, byte order mark (uint32), size and modification time
+// of the source text file (doubles, -1 if unknown), length (uint32) and
+// characters of the source file name (empty if unknown), number of lines
+// (uint32), then for each line: number of values (uint32) and the values
+// (doubles).
+// Numbers are in native byte order; files with a different byte order are
+// rejected.
+static const char BINARY_MAGIC[8] = {'B','M','B','I','N','0','0','2'};
+static const uint32 BYTE_ORDER_MARK = 0x01020304;
+
 
 const BonnMotionFile::Line *BonnMotionFile::getLine(int nodeId) const
 {
-    LineList::const_iterator it = lines.begin();
-    for (int i=0; i<nodeId && it!=lines.end(); i++) it++;
-    return (it==lines.end()) ? NULL : &(*it);
+    return (nodeId<0 || nodeId>=(int)lines.size()) ? NULL : &lines[nodeId];
 }
 
 
@@ -46,7 +65,32 @@ void BonnMotionFileCache::deleteInstance()
     }
 }
 
-const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
+static bool getFileStamp(const char *filename, double& size, double& mtime)
+{
+    struct stat st;
+    if (stat(filename, &st) != 0)
+        return false;
+    size = (double)st.st_size;
+    mtime = (double)st.st_mtime;
+    return true;
+}
+
+static bool readWholeFile(const char *filename, std::vector<char>& buffer)
+{
+    std::ifstream in(filename, std::ios::in|std::ios::binary);
+    if (in.fail())
+        return false;
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    buffer.resize((size_t)size + 1);
+    if (size > 0 && !in.read(&buffer[0], size))
+        return false;
+    buffer[(size_t)size] = '\0';  // for strtod()
+    return true;
+}
+
+const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename, const char *binaryCacheFile)
 {
     // if found, return it from cache
     BMFileMap::iterator it = cache.find(std::string(filename));
@@ -55,29 +99,173 @@ const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
 
     // load and store in cache
     BonnMotionFile& bmFile = cache[filename];
+
+    if (binaryCacheFile && *binaryCacheFile)
+    {
+        // use the binary file if it was saved from the current version of the same file
+        double size, mtime, savedSize, savedTime;
+        std::string savedName;
+        std::vector<char> buffer;
+        if (getFileStamp(filename, size, mtime) && readWholeFile(binaryCacheFile, buffer) &&
+            parseBinary(&buffer[0], &buffer[0] + buffer.size() - 1, bmFile, &savedSize, &savedTime, &savedName) &&
+            size == savedSize && mtime == savedTime && savedName == filename)
+            return &bmFile;
+        bmFile.lines.clear();
+    }
+
     parseFile(filename, bmFile);
+
+    if (binaryCacheFile && *binaryCacheFile)
+        saveBinaryFile(binaryCacheFile, bmFile, filename);
     return &bmFile;
 }
 
 void BonnMotionFileCache::parseFile(const char *filename, BonnMotionFile& bmFile)
 {
-    std::ifstream in(filename, std::ios::in);
-    if (in.fail())
+    // read the whole file into memory and parse it in place, which is a lot
+    // faster than std::getline() and a std::stringstream per line
+    std::vector<char> buffer;
+    if (!readWholeFile(filename, buffer))
         opp_error("Cannot open file '%s'",filename);
 
-    std::string line;
-    while (std::getline(in, line))
+    const char *data = &buffer[0];
+    const char *end = data + buffer.size() - 1;
+    if (end - data >= (int)sizeof(BINARY_MAGIC) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0)
+    {
+        if (!parseBinary(data, end, bmFile, NULL, NULL, NULL))
+            opp_error("Invalid or truncated binary BonnMotion file '%s'", filename);
+    }
+    else
+        parseText(data, end, bmFile);
+}
+
+void BonnMotionFileCache::parseText(const char *s, const char *end, BonnMotionFile& bmFile)
+{
+    // like the original getline()-based parser: every line is a node, and
+    // the numbers in a line are read until the first non-number
+    bmFile.lines.reserve(std::count(s, end, '\n') + 1);
+    while (s < end)
     {
+        const char *eol = (const char *)memchr(s, '\n', end - s);
+        if (!eol)
+            eol = end;
+
         bmFile.lines.push_back(BonnMotionFile::Line());
         BonnMotionFile::Line& vec = bmFile.lines.back();
-
-        std::stringstream linestream(line);
-        double d;
-        while (linestream >> d)
+        while (true)
+        {
+            while (s < eol && (*s==' ' || *s=='\t' || *s=='\r'))
+                s++;
+            if (s >= eol)
+                break;
+            char *next;
+            double d = strtod(s, &next);
+            if (next == s || next > eol)
+                break;
             vec.push_back(d);
+            s = next;
+        }
+        s = eol + 1;
     }
-    in.close();
 }
 
+template<typename T>
+static bool readBinaryValue(const char *& p, const char *end, T& value)
+{
+    if (end - p < (int)sizeof(T))
+        return false;
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+bool BonnMotionFileCache::parseBinary(const char *p, const char *end, BonnMotionFile& bmFile, double *sourceSize, double *sourceTime, std::string *sourceName)
+{
+    uint32 bom, nameLength, numLines;
+    double size, mtime;
+    if (end - p < (int)sizeof(BINARY_MAGIC) || memcmp(p, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+        return false;
+    p += sizeof(BINARY_MAGIC);
+    if (!readBinaryValue(p, end, bom) || bom != BYTE_ORDER_MARK)
+        return false;
+    if (!readBinaryValue(p, end, size) || !readBinaryValue(p, end, mtime) || !readBinaryValue(p, end, nameLength))
+        return false;
+    if ((uint32)(end - p) < nameLength)
+        return false;
+    if (sourceName)
+        sourceName->assign(p, nameLength);
+    p += nameLength;
+    if (!readBinaryValue(p, end, numLines))
+        return false;
+    if (sourceSize)
+        *sourceSize = size;
+    if (sourceTime)
+        *sourceTime = mtime;
+
+    bmFile.lines.resize(numLines);
+    for (uint32 i = 0; i < numLines; i++)
+    {
+        uint32 n;
+        if (!readBinaryValue(p, end, n) || (uint32)(end - p) / sizeof(double) < n)
+            return false;
+        BonnMotionFile::Line& vec = bmFile.lines[i];
+        vec.resize(n);
+        if (n > 0)
+            memcpy(&vec[0], p, n * sizeof(double));
+        p += n * sizeof(double);
+    }
+    return true;
+}
+
+void BonnMotionFileCache::saveBinaryFile(const char *filename, const BonnMotionFile& bmFile, const char *sourceFile)
+{
+    double size = -1, mtime = -1;
+    if (sourceFile)
+        getFileStamp(sourceFile, size, mtime);
+
+    // Write into a temporary file, then rename it, so that runs started at
+    // the same time never load a partially written file.
+    std::stringstream tmpName;
+    tmpName << filename << "." << getpid() << ".tmp";
+    std::string tmpFileName = tmpName.str();
 
+    std::ofstream out(tmpFileName.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+    if (!out.is_open())
+        opp_error("Cannot open file '%s' for writing", tmpFileName.c_str());
+
+    uint32 nameLength = sourceFile ? strlen(sourceFile) : 0;
+    uint32 numLines = bmFile.lines.size();
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    out.write((const char *)&BYTE_ORDER_MARK, sizeof(BYTE_ORDER_MARK));
+    out.write((const char *)&size, sizeof(size));
+    out.write((const char *)&mtime, sizeof(mtime));
+    out.write((const char *)&nameLength, sizeof(nameLength));
+    if (nameLength > 0)
+        out.write(sourceFile, nameLength);
+    out.write((const char *)&numLines, sizeof(numLines));
+    for (uint32 i = 0; i < numLines; i++)
+    {
+        const BonnMotionFile::Line& vec = bmFile.lines[i];
+        uint32 n = vec.size();
+        out.write((const char *)&n, sizeof(n));
+        if (n > 0)
+            out.write((const char *)&vec[0], n * sizeof(double));
+    }
+
+    out.close();
+    if (out.fail())
+    {
+        remove(tmpFileName.c_str());
+        opp_error("Error writing file '%s'", tmpFileName.c_str());
+    }
+
+#if defined(_WIN32)
+    remove(filename);  // rename() does not replace existing files on Windows
+#endif
+    if (rename(tmpFileName.c_str(), filename) != 0)
+    {
+        remove(tmpFileName.c_str());
+        opp_error("Cannot rename '%s' to '%s'", tmpFileName.c_str(), filename);
+    }
+}
 
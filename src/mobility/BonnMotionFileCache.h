@@ -18,10 +18,11 @@
 #ifndef BONNMOTIONFILECACHE_H
 #define BONNMOTIONFILECACHE_H
 
-#include <list>
+#include <map>
+#include <string>
 #include <vector>
 #include <omnetpp.h>
-#include "BasicMobility.h"
+#include "INETDefs.h"
 
 class BonnMotionFileCache;
 
@@ -35,10 +36,11 @@ class INET_API BonnMotionFile
     typedef std::vector<double> Line;
   protected:
     friend class BonnMotionFileCache;
-    typedef std::list<Line> LineList;
-    LineList lines;
+    typedef std::vector<Line> LineVector;
+    LineVector lines;  // indexed by node id
   public:
     const Line *getLine(int nodeId) const;
+    int getNumLines() const {return lines.size();}
 };
 
 
@@ -47,6 +49,10 @@ class INET_API BonnMotionFile
  * BonnMotionMobility.  Needed because otherwise every node would
  * have to open and read the file independently.
  *
+ * Besides the BonnMotion text format, files can also be in a binary
+ * format (written by saveBinaryFile()), which loads without parsing.
+ * The format is detected from the contents of the file.
+ *
  * @ingroup mobility
  * @author Andras Varga
  */
@@ -57,6 +63,8 @@ class INET_API BonnMotionFileCache
     BMFileMap cache;
     static BonnMotionFileCache *inst;
     void parseFile(const char *filename, BonnMotionFile& bmFile);
+    void parseText(const char *text, const char *end, BonnMotionFile& bmFile);
+    bool parseBinary(const char *data, const char *end, BonnMotionFile& bmFile, double *sourceSize, double *sourceTime, std::string *sourceName);
     BonnMotionFileCache() {}
     virtual ~BonnMotionFileCache() {}
 
@@ -72,9 +80,20 @@ class INET_API BonnMotionFileCache
     static void deleteInstance();
 
     /**
-     * Returns the given document.
+     * Returns the given document. If binaryCacheFile is given, the contents
+     * are loaded from there if it was saved from the current version of the
+     * same file (same name as given here, size and modification time);
+     * otherwise the file is parsed, and saved into binaryCacheFile.
+     */
+    virtual const BonnMotionFile *getFile(const char *filename, const char *binaryCacheFile=NULL);
+
+    /**
+     * Writes the contents in the binary format. sourceFile is the text file
+     * it was read from, or NULL; its name, size and modification time are
+     * stored, so that getFile() can tell if the binary file is up to date.
+     * The file is written under a temporary name, then renamed.
      */
-    virtual const BonnMotionFile *getFile(const char *filename);
+    virtual void saveBinaryFile(const char *filename, const BonnMotionFile& bmFile, const char *sourceFile=NULL);
 };
 
 #endif
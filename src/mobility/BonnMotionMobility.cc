@@ -36,7 +36,8 @@ void BonnMotionMobility::initialize(int stage)
             nodeId = getParentModule()->getIndex();
 
         const char *fname = par("traceFile");
-        const BonnMotionFile *bmFile = BonnMotionFileCache::getInstance()->getFile(fname);
+        const char *binaryCacheFile = par("binaryCacheFile");
+        const BonnMotionFile *bmFile = BonnMotionFileCache::getInstance()->getFile(fname, binaryCacheFile);
 
         vecp = bmFile->getLine(nodeId);
         if (!vecp)
@@ -48,9 +48,11 @@ void CircleMobility::initialize(int stage)
         // if the initial speed is lower than 0, the node is stationary
         stationary = (speed == 0);
 
-        // host moves the first time after some random delay to avoid synchronized movements
-        if (!stationary)
-            scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move"));
+        // with lazyPositions, the host moves without any events;
+        // otherwise it moves the first time after some random delay to avoid synchronized movements
+        angleTime = simTime();
+        if (!stationary && !lazyPositions)
+            scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move"));
     }
 }
 
@@ -59,7 +61,7 @@ void CircleMobility::handleSelfMsg(cMessage * msg)
 {
     move();
     updatePosition();
-    scheduleAt(simTime() + updateInterval, msg);
+    scheduleUpdate(simTime() + updateInterval, msg);
 }
 
 void CircleMobility::move()
@@ -70,3 +72,12 @@ void CircleMobility::move()
 
     EV << " xpos= " << pos.x << " ypos=" << pos.y << endl;
 }
+
+Coord CircleMobility::getPositionAt(simtime_t t)
+{
+    if (!lazyPositions || stationary)
+        return pos;
+    double a = angle + omega * SIMTIME_DBL(t - angleTime);
+    return Coord(cx + r * cos(a), cy + r * sin(a));
+}
+
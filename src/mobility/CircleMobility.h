@@ -41,6 +41,7 @@ class INET_API CircleMobility : public BasicMobility
 
     // state
     double angle;  ///< direction from the centre of the circle
+    simtime_t angleTime;  ///< when angle was valid (used with lazyPositions)
 
   protected:
     /** @brief Initializes mobility model parameters.*/
@@ -52,6 +53,10 @@ class INET_API CircleMobility : public BasicMobility
 
     /** @brief Move the host*/
     virtual void move();
+
+  public:
+    /** @brief With lazyPositions, returns the position on the circle at time t */
+    virtual Coord getPositionAt(simtime_t t);
 };
 
 #endif
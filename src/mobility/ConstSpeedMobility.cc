@@ -46,12 +46,18 @@ void ConstSpeedMobility::initialize(int stage)
         // if the initial speed is lower than 0, the node is stationary
         stationary = (vHost <= 0);
 
+        // with lazyPositions, the first event chooses the first target once the
+        // position is known, and there are only events when a target is reached
+        segmentStartTime = segmentEndTime = simTime();
+        if (!stationary && lazyPositions)
+            scheduleAt(simTime(), new cMessage("move"));
+
         //calculate the target position of the host if the host moves
-        if (!stationary)
+        else if (!stationary)
         {
             setTargetPosition();
             //host moves the first time after some random delay to avoid synchronized movements
-            scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move"));
+            scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move"));
         }
     }
 }
@@ -63,9 +69,21 @@ void ConstSpeedMobility::initialize(int stage)
  */
 void ConstSpeedMobility::handleSelfMsg(cMessage * msg)
 {
+    if (lazyPositions)
+    {
+        pos = getPositionAt(simTime());
+        targetPos = getRandomPosition();
+        segmentStartTime = simTime();
+        segmentEndTime = simTime() + pos.distance(targetPos) / vHost;
+        EV << "xpos= " << targetPos.x << " ypos=" << targetPos.y << " arrival at t=" << segmentEndTime << endl;
+        updatePosition();
+        scheduleAt(segmentEndTime, msg);
+        return;
+    }
+
     move();
     updatePosition();
-    scheduleAt(simTime() + updateInterval, msg);
+    scheduleUpdate(simTime() + updateInterval, msg);
 }
 
 
@@ -111,3 +129,14 @@ void ConstSpeedMobility::move()
         setTargetPosition();
     }
 }
+
+Coord ConstSpeedMobility::getPositionAt(simtime_t t)
+{
+    if (!lazyPositions || stationary || segmentEndTime <= segmentStartTime)
+        return pos;
+    if (t >= segmentEndTime)
+        return targetPos;
+    double fraction = SIMTIME_DBL(t - segmentStartTime) / SIMTIME_DBL(segmentEndTime - segmentStartTime);
+    return pos + (targetPos - pos) * fraction;
+}
+
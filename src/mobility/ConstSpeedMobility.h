@@ -58,6 +58,9 @@ class INET_API ConstSpeedMobility : public BasicMobility
     int step;
     /*@}*/
 
+    /** @brief with lazyPositions: the host moves from pos to targetPos between these times */
+    simtime_t segmentStartTime, segmentEndTime;
+
   protected:
     /** @brief Initializes mobility model parameters.*/
     virtual void initialize(int);
@@ -70,6 +73,10 @@ class INET_API ConstSpeedMobility : public BasicMobility
 
     /** @brief Move the host*/
     virtual void move();
+
+  public:
+    /** @brief With lazyPositions, returns the position on the way to targetPos */
+    virtual Coord getPositionAt(simtime_t t);
 };
 
 #endif
@@ -30,9 +30,15 @@ void LineSegmentsMobilityBase::initialize(int stage)
         stationary = false;
         targetPos = pos;
         targetTime = simTime();
-
-        // host moves the first time after some random delay to avoid synchronized movements
-        scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move"));
+        segmentStartTime = simTime();
+        lastStepTime = simTime();
+
+        // with lazy positions there are no periodic updates, so we can start right away;
+        // otherwise host moves the first time after some random delay to avoid synchronized movements
+        if (lazyPositions)
+            scheduleAt(simTime(), new cMessage("move"));
+        else
+            scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move"));
     }
 }
 
@@ -54,6 +60,14 @@ void LineSegmentsMobilityBase::beginNextMove(cMessage *msg)
         step.x = step.y = 0;
         delete msg;
     }
+    else if (lazyPositions)
+    {
+        // the position is interpolated by getPositionAt(), we only need an
+        // event at the end of the segment
+        step.x = step.y = 0;
+        segmentStartTime = now;
+        scheduleAt(std::max(targetTime,simTime()), msg);
+    }
     else if (targetPos==pos)
     {
         // no movement, just wait
@@ -72,7 +86,7 @@ void LineSegmentsMobilityBase::beginNextMove(cMessage *msg)
         //        = (targetPos-pos) / (targetTime-now) * updateInterval =
         //        = (targetPos-pos) / numIntervals
         step = (targetPos - pos) / numIntervals;
-        scheduleAt(simTime() + updateInterval, msg);
+        scheduleUpdate(simTime() + updateInterval, msg);
     }
 }
 
@@ -83,17 +97,21 @@ void LineSegmentsMobilityBase::handleSelfMsg(cMessage *msg)
         delete msg;
         return;
     }
-    else if (simTime()+updateInterval >= targetTime)
-    {
+
+    bool segmentBegins = lazyPositions || simTime()+updateInterval >= targetTime;
+    if (segmentBegins)
         beginNextMove(msg);
-    }
     else
-    {
-        scheduleAt(simTime() + updateInterval, msg);
-    }
+        scheduleUpdate(simTime() + updateInterval, msg);
 
-    // update position
-    pos += step;
+    // update position; with a MobilityScheduler, the first update after a
+    // pause comes at the next tick, which may be sooner than updateInterval,
+    // so the step is scaled by the time actually elapsed since the last one
+    if (scheduler && !segmentBegins)
+        pos += step * (SIMTIME_DBL(simTime() - lastStepTime) / updateInterval);
+    else
+        pos += step;
+    lastStepTime = simTime();
 
     // do something if we reach the wall
     fixIfHostGetsOutside();
@@ -103,4 +121,13 @@ void LineSegmentsMobilityBase::handleSelfMsg(cMessage *msg)
     updatePosition();
 }
 
+Coord LineSegmentsMobilityBase::getPositionAt(simtime_t t)
+{
+    if (!lazyPositions || stationary || targetTime <= segmentStartTime)
+        return pos;
+    if (t >= targetTime)
+        return targetPos;
+    double fraction = SIMTIME_DBL(t - segmentStartTime) / SIMTIME_DBL(targetTime - segmentStartTime);
+    return pos + (targetPos - pos) * fraction;
+}
 
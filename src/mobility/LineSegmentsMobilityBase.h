@@ -42,6 +42,8 @@ class INET_API LineSegmentsMobilityBase : public BasicMobility
     simtime_t targetTime;  ///< end time of current linear movement
     Coord targetPos;       ///< end position of current linear movement
     Coord step;            ///< step size (added to pos every updateInterval)
+    simtime_t segmentStartTime; ///< start time of current linear movement (used with lazyPositions)
+    simtime_t lastStepTime; ///< when step was last added to pos
     bool stationary;       ///< if set to true, host won't move
 
   protected:
@@ -67,6 +69,13 @@ class INET_API LineSegmentsMobilityBase : public BasicMobility
      * or directly one of the methods it relies on.
      */
     virtual void fixIfHostGetsOutside() = 0;
+
+  public:
+    /**
+     * @brief With lazyPositions, interpolates between pos and targetPos;
+     * note that fixIfHostGetsOutside() is only applied at the segment ends.
+     */
+    virtual Coord getPositionAt(simtime_t t);
 };
 
 #endif
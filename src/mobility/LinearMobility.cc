@@ -16,6 +16,7 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>   // min,max
 #include "LinearMobility.h"
 #include "FWMath.h"
 
@@ -40,9 +41,20 @@ void LinearMobility::initialize(int stage)
         // if the initial speed is lower than 0, the node is stationary
         stationary = (speed == 0);
 
+        if (lazyPositions)
+        {
+            if (acceleration != 0)
+                error("lazyPositions=true requires acceleration=0");
+
+            // the first event starts the first segment, once the position is known
+            segmentStartTime = segmentEndTime = simTime();
+            reflectX = reflectY = false;
+            if (!stationary)
+                scheduleAt(simTime(), new cMessage("move"));
+        }
         // host moves the first time after some random delay to avoid synchronized movements
-        if (!stationary)
-            scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move"));
+        else if (!stationary)
+            scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move"));
     }
 }
 
@@ -53,10 +65,28 @@ void LinearMobility::initialize(int stage)
  */
 void LinearMobility::handleSelfMsg(cMessage * msg)
 {
+    if (lazyPositions)
+    {
+        // a wall has been reached (or this is the start): bounce off it
+        pos = getPositionAt(simTime());
+        pos.x = std::max(0.0, std::min(getPlaygroundSizeX(), pos.x));
+        pos.y = std::max(0.0, std::min(getPlaygroundSizeY(), pos.y));
+        if (reflectX)
+            angle = 180 - angle;
+        if (reflectY)
+            angle = -angle;
+        if (beginSegment())
+            scheduleAt(segmentEndTime, msg);
+        else
+            delete msg;
+        updatePosition();
+        return;
+    }
+
     move();
     updatePosition();
     if (!stationary)
-        scheduleAt(simTime() + updateInterval, msg);
+        scheduleUpdate(simTime() + updateInterval, msg);
 }
 
 /**
@@ -82,3 +112,38 @@ void LinearMobility::move()
 
     EV << " xpos= " << pos.x << " ypos=" << pos.y << " speed=" << speed << endl;
 }
+
+bool LinearMobility::beginSegment()
+{
+    segmentStartTime = simTime();
+    velocity.x = speed * cos(PI * angle / 180);
+    velocity.y = speed * sin(PI * angle / 180);
+
+    // time until the host hits the walls in the x and y directions
+    double tx = velocity.x > 0 ? (getPlaygroundSizeX() - pos.x) / velocity.x :
+                velocity.x < 0 ? -pos.x / velocity.x : MAXTIME.dbl();
+    double ty = velocity.y > 0 ? (getPlaygroundSizeY() - pos.y) / velocity.y :
+                velocity.y < 0 ? -pos.y / velocity.y : MAXTIME.dbl();
+    reflectX = tx <= ty;
+    reflectY = ty <= tx;
+
+    // the host may be so slow that it never reaches a wall
+    double maxDuration = SIMTIME_DBL(MAXTIME - segmentStartTime);
+    if (std::min(tx, ty) >= maxDuration)
+    {
+        segmentEndTime = MAXTIME;
+        return false;
+    }
+    segmentEndTime = segmentStartTime + std::min(tx, ty);
+
+    EV << " xpos= " << pos.x << " ypos=" << pos.y << " next wall at t=" << segmentEndTime << endl;
+    return true;
+}
+
+Coord LinearMobility::getPositionAt(simtime_t t)
+{
+    if (!lazyPositions || stationary)
+        return pos;
+    return pos + velocity * SIMTIME_DBL(t - segmentStartTime);
+}
+
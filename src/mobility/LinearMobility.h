@@ -38,6 +38,12 @@ class INET_API LinearMobility : public BasicMobility
     double updateInterval; ///< time interval to update the hosts position
     bool stationary;       ///< if true, the host doesn't move
 
+    // lazyPositions: the host moves from pos with velocity until it hits a wall at segmentEndTime
+    simtime_t segmentStartTime;
+    simtime_t segmentEndTime;
+    Coord velocity;
+    bool reflectX, reflectY;  ///< which wall(s) are hit at segmentEndTime
+
   protected:
     /** @brief Initializes mobility model parameters.*/
     virtual void initialize(int);
@@ -48,6 +54,17 @@ class INET_API LinearMobility : public BasicMobility
 
     /** @brief Move the host*/
     virtual void move();
+
+    /**
+     * @brief With lazyPositions: starts moving from pos at the current angle,
+     * and sets segmentEndTime to the time a wall is hit. Returns false if
+     * that would be after the end of the simulation time.
+     */
+    virtual bool beginSegment();
+
+  public:
+    /** @brief With lazyPositions, returns the position on the current line segment */
+    virtual Coord getPositionAt(simtime_t t);
 };
 
 #endif
@@ -54,7 +54,7 @@ void MassMobility::initialize(int stage)
         step.x = currentSpeed * cos(PI * currentAngle / 180) * updateInterval;
         step.y = currentSpeed * sin(PI * currentAngle / 180) * updateInterval;
 
-        scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move", MK_UPDATE_POS));
+        scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move", MK_UPDATE_POS));
         scheduleAt(simTime() + uniform(0, changeInterval->doubleValue()), new cMessage("turn", MK_CHANGE_DIR));
     }
 }
@@ -70,7 +70,7 @@ void MassMobility::handleSelfMsg(cMessage * msg)
     case MK_UPDATE_POS:
         move();
         updatePosition();
-        scheduleAt(simTime() + updateInterval, msg);
+        scheduleUpdate(simTime() + updateInterval, msg);
         break;
     case MK_CHANGE_DIR:
         currentAngle += changeAngleBy->doubleValue();
@@ -0,0 +1,100 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "MobilityScheduler.h"
+#include "BasicMobility.h"
+#include "ChannelControl.h"
+
+
+Define_Module(MobilityScheduler);
+
+
+MobilityScheduler::MobilityScheduler()
+{
+    tickMsg = NULL;
+    cc = NULL;
+    updating = false;
+}
+
+MobilityScheduler::~MobilityScheduler()
+{
+    cancelAndDelete(tickMsg);
+}
+
+MobilityScheduler *MobilityScheduler::find()
+{
+    return dynamic_cast<MobilityScheduler *>(simulation.getModuleByPath("mobilityScheduler"));
+}
+
+void MobilityScheduler::initialize()
+{
+    updateInterval = getUpdateInterval();
+    if (updateInterval <= 0)
+        error("updateInterval must be positive");
+    cc = ChannelControl::get();
+
+    numTicks = numUpdates = 0;
+    WATCH(numTicks);
+    WATCH(numUpdates);
+}
+
+void MobilityScheduler::scheduleUpdate(cModule *mobility)
+{
+    // may be called before initialize()
+    Enter_Method_Silent();
+    if (!tickMsg)
+        tickMsg = new cMessage("tick");
+    dueModelIds.push_back(mobility->getId());
+    if (!tickMsg->isScheduled())
+        scheduleAt(simTime() + getUpdateInterval(), tickMsg);
+}
+
+void MobilityScheduler::handleMessage(cMessage *msg)
+{
+    if (msg != tickMsg)
+        error("unexpected message");
+
+    // models that are updated now ask for the next update during the loop
+    std::vector<int> modelIds;
+    modelIds.swap(dueModelIds);
+
+    updating = true;
+    for (unsigned int i=0; i<modelIds.size(); i++)
+    {
+        // the module may have been deleted since it asked for the update
+        BasicMobility *mobility = dynamic_cast<BasicMobility *>(simulation.getModule(modelIds[i]));
+        if (mobility)
+            mobility->handleScheduledUpdate();
+    }
+    updating = false;
+
+    // the models only stored their new positions, update the connectivity in one go
+    cc->updateAllConnections();
+
+    numTicks++;
+    numUpdates += modelIds.size();
+
+    if (!dueModelIds.empty() && !tickMsg->isScheduled())
+        scheduleAt(simTime() + updateInterval, tickMsg);
+}
+
+void MobilityScheduler::finish()
+{
+    recordScalar("ticks", numTicks);
+    recordScalar("position updates", numUpdates);
+}
+
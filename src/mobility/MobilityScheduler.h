@@ -0,0 +1,75 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef MOBILITY_SCHEDULER_H
+#define MOBILITY_SCHEDULER_H
+
+#include <vector>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+class ChannelControl;
+
+
+/**
+ * Drives the periodic position updates of all mobility models in the
+ * network with one event per update interval. See the NED file for details.
+ *
+ * Mobility models (BasicMobility subclasses) find the scheduler in
+ * initialize(), and pass their position update message to it instead of
+ * scheduling it (see BasicMobility::scheduleUpdate()). At every tick, the
+ * scheduler invokes the models whose update is due, then lets
+ * ChannelControl recompute the connectivity of all hosts in one pass.
+ *
+ * @ingroup mobility
+ */
+class INET_API MobilityScheduler : public cSimpleModule
+{
+  protected:
+    simtime_t updateInterval;
+    ChannelControl *cc;
+    cMessage *tickMsg;
+    std::vector<int> dueModelIds;  // module ids of the models to update at the next tick
+    bool updating;                 // true during the tick
+
+    long numTicks;
+    long numUpdates;
+
+  protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+  public:
+    MobilityScheduler();
+    virtual ~MobilityScheduler();
+
+    /** @brief Returns the "mobilityScheduler" module of the network, or NULL if there is none */
+    static MobilityScheduler *find();
+
+    /** @brief The interval of the position updates; it overrides the updateInterval of the models */
+    simtime_t getUpdateInterval() {return par("updateInterval").doubleValue();}
+
+    /** @brief Asks for calling BasicMobility::handleScheduledUpdate() of the given model at the next tick */
+    virtual void scheduleUpdate(cModule *mobility);
+
+    /** @brief Returns true while the models are being updated */
+    bool isUpdating() const {return updating;}
+};
+
+#endif
+
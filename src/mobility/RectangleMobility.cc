@@ -68,9 +68,15 @@ void RectangleMobility::initialize(int stage)
         WATCH(d);
         updatePosition();
 
-        // host moves the first time after some random delay to avoid synchronized movements
-        if (!stationary)
-            scheduleAt(simTime() + uniform(0, updateInterval), new cMessage("move"));
+        if (corner4 <= 0)
+            stationary = true;
+
+        // with lazyPositions, the host only needs an event at the corners;
+        // otherwise it moves the first time after some random delay to avoid synchronized movements
+        if (!stationary && lazyPositions)
+            scheduleAt(beginSegment(), new cMessage("move"));
+        else if (!stationary)
+            scheduleUpdate(simTime() + uniform(0, updateInterval), new cMessage("move"));
     }
 }
 
@@ -81,9 +87,21 @@ void RectangleMobility::initialize(int stage)
  */
 void RectangleMobility::handleSelfMsg(cMessage * msg)
 {
+    if (lazyPositions)
+    {
+        // reached a corner
+        d = segmentEndD;
+        if (d >= corner4)
+            d -= corner4;
+        calculateXY();
+        updatePosition();
+        scheduleAt(beginSegment(), msg);
+        return;
+    }
+
     move();
     updatePosition();
-    scheduleAt(simTime() + updateInterval, msg);
+    scheduleUpdate(simTime() + updateInterval, msg);
 }
 
 void RectangleMobility::move()
@@ -98,28 +116,52 @@ void RectangleMobility::move()
 
 void RectangleMobility::calculateXY()
 {
-    if (d < corner1)
-    {
-        // top side
-        pos.x = x1 + d;
-        pos.y = y1;
-    }
-    else if (d < corner2)
-    {
-        // right side
-        pos.x = x2;
-        pos.y = y1 + d - corner1;
-    }
-    else if (d < corner3)
+    pos = calculateXY(d);
+}
+
+Coord RectangleMobility::calculateXY(double dist) const
+{
+    if (dist < corner1)
+        return Coord(x1 + dist, y1); // top side
+    else if (dist < corner2)
+        return Coord(x2, y1 + dist - corner1); // right side
+    else if (dist < corner3)
+        return Coord(x2 - dist + corner2, y2); // bottom side
+    else
+        return Coord(x1, y2 - dist + corner3); // left side
+}
+
+simtime_t RectangleMobility::beginSegment()
+{
+    segmentStartTime = simTime();
+
+    // the next corner in the direction of the movement (zero-length sides are skipped)
+    double corners[] = {0, corner1, corner2, corner3, corner4};
+    if (speed > 0)
     {
-        // bottom side
-        pos.x = x2 - d + corner2;
-        pos.y = y2;
+        int i = 0;
+        while (corners[i] <= d)
+            i++;
+        segmentEndD = corners[i];
     }
     else
     {
-        // left side
-        pos.x = x1;
-        pos.y = y2 - d + corner3;
+        if (d <= 0)
+            d += corner4;
+        int i = 4;
+        while (corners[i] >= d)
+            i--;
+        segmentEndD = corners[i];
     }
+    return simTime() + (segmentEndD - d) / speed;
+}
+
+Coord RectangleMobility::getPositionAt(simtime_t t)
+{
+    if (!lazyPositions || stationary)
+        return pos;
+    double dist = d + speed * SIMTIME_DBL(t - segmentStartTime);
+    while (dist < 0) dist += corner4;
+    while (dist >= corner4) dist -= corner4;
+    return calculateXY(dist);
 }
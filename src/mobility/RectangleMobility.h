@@ -41,6 +41,10 @@ class INET_API RectangleMobility : public BasicMobility
     double d;  ///< distance from (x1,y1), measured clockwise on the perimeter
     double corner1, corner2, corner3, corner4;
 
+    // lazyPositions: the host moves from d at segmentStartTime to the corner at segmentEndD
+    simtime_t segmentStartTime;
+    double segmentEndD;
+
   protected:
     /** @brief Initializes mobility model parameters. */
     virtual void initialize(int);
@@ -53,6 +57,16 @@ class INET_API RectangleMobility : public BasicMobility
 
     /** @brief Maps d to (x,y) coordinates */
     virtual void calculateXY();
+
+    /** @brief Maps the given distance from (x1,y1) to (x,y) coordinates */
+    Coord calculateXY(double dist) const;
+
+    /** @brief With lazyPositions: starts moving towards the next corner, and returns the time it is reached */
+    virtual simtime_t beginSegment();
+
+  public:
+    /** @brief With lazyPositions, returns the position on the perimeter at time t */
+    virtual Coord getPositionAt(simtime_t t);
 };
 
 #endif
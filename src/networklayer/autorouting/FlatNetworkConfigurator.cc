@@ -16,12 +16,15 @@
 //
 
 #include <algorithm>
+#include <time.h>
 #include "IRoutingTable.h"
 #include "IInterfaceTable.h"
 #include "IPAddressResolver.h"
 #include "FlatNetworkConfigurator.h"
 #include "InterfaceEntry.h"
 #include "IPv4InterfaceData.h"
+#include "UnweightedShortestPaths.h"
+#include "NetworkConfigurationCache.h"
 
 
 Define_Module(FlatNetworkConfigurator);
@@ -31,6 +34,8 @@ void FlatNetworkConfigurator::initialize(int stage)
 {
     if (stage==2)
     {
+        clock_t startTime = clock();
+
         cTopology topo("topo");
         NodeInfoVector nodeInfo; // will be of size topo.nodes[]
 
@@ -38,15 +43,40 @@ void FlatNetworkConfigurator::initialize(int stage)
         // isIPNode, rt and ift members of nodeInfo[]
         extractTopology(topo, nodeInfo);
 
-        // assign addresses to IP nodes, and also store result in nodeInfo[].address
-        assignAddresses(topo, nodeInfo);
+        // load the configuration from the cache file if it was saved for the same network
+        const char *cacheFile = par("cacheFile");
+        NetworkConfigurationCache cache;
+        bool loaded = false;
+        if (*cacheFile)
+        {
+            for (int i=0; i<topo.getNumNodes(); i++)
+                cache.addNode(topo.getNode(i), nodeInfo[i].ift, nodeInfo[i].rt);
+            cache.addParameter(par("networkAddress"));
+            cache.addParameter(par("netmask"));
+            cache.addParameter(par("aggregateRoutes"));
+            loaded = cache.load(cacheFile);
+        }
 
-        // add default routes to hosts (nodes with a single attachment);
-        // also remember result in nodeInfo[].usesDefaultRoute
-        addDefaultRoutes(topo, nodeInfo);
+        if (!loaded)
+        {
+            // assign addresses to IP nodes, and also store result in nodeInfo[].address
+            assignAddresses(topo, nodeInfo);
 
-        // calculate shortest paths, and add corresponding static routes
-        fillRoutingTables(topo, nodeInfo);
+            // add default routes to hosts (nodes with a single attachment);
+            // also remember result in nodeInfo[].usesDefaultRoute
+            addDefaultRoutes(topo, nodeInfo);
+
+            // calculate shortest paths, and add corresponding static routes
+            fillRoutingTables(topo, nodeInfo);
+
+            if (*cacheFile)
+                cache.save(cacheFile);
+        }
+
+        configurationTime = (double)(clock()-startTime)/CLOCKS_PER_SEC;
+        loadedFromCache = loaded;
+        EV << "network configured in " << configurationTime << "s"
+           << (!*cacheFile ? "" : loaded ? ", loaded from " : ", saved to ") << cacheFile << endl;
 
         // update display string
         setDisplayString(topo, nodeInfo);
@@ -148,59 +178,184 @@ void FlatNetworkConfigurator::addDefaultRoutes(cTopology& topo, NodeInfoVector&
 
 void FlatNetworkConfigurator::fillRoutingTables(cTopology& topo, NodeInfoVector& nodeInfo)
 {
-    // fill in routing tables with static routes
-    for (int i=0; i<topo.getNumNodes(); i++)
-    {
-        cTopology::Node *destNode = topo.getNode(i);
+    int numNodes = topo.getNumNodes();
 
-        // skip bus types
+    // destinations are the IP nodes; routes are added to every IP node excepting
+    // nodes with only one interface -- there we've already set up a default route
+    std::vector<int> destNodes;
+    std::vector<int> routerNodes;
+    for (int i=0; i<numNodes; i++)
+    {
         if (!nodeInfo[i].isIPNode)
-            continue;
+            continue; // skip bus types
+        destNodes.push_back(i);
+        if (!nodeInfo[i].usesDefaultRoute)
+            routerNodes.push_back(i);
+    }
+    int numDests = destNodes.size();
+    int numRouters = routerNodes.size();
+
+    // calculate shortest paths towards each destination, and record the output
+    // gate of each router towards it: nextHopGateIds[router*numDests+dest],
+    // -1 if the destination cannot be reached (or it is the router itself)
+    std::vector<int> nextHopGateIds(numRouters*numDests, -1);
+    UnweightedShortestPaths paths(topo);
+    for (int d=0; d<numDests; d++)
+    {
+        paths.calculatePathsTo(destNodes[d]);
+        for (int r=0; r<numRouters; r++)
+            nextHopGateIds[r*numDests+d] = paths.getOutputGateId(routerNodes[r]);
+    }
+
+    // add routes to the routing table of each router
+    bool aggregate = par("aggregateRoutes").boolValue();
+    uint32 networkAddress = IPAddress(par("networkAddress").stringValue()).getInt();
+    uint32 netmask = IPAddress(par("netmask").stringValue()).getInt();
+    for (int r=0; r<numRouters; r++)
+    {
+        int j = routerNodes[r];
+        IInterfaceTable *ift = nodeInfo[j].ift;
+        RouteTargetVector targets;
+        targets.reserve(numDests);
+        for (int d=0; d<numDests; d++)
+        {
+            int i = destNodes[d];
+            RouteTarget target;
+            target.address = nodeInfo[i].address.getInt();
+            target.ie = NULL;
+            if (i!=j)
+            {
+                int outputGateId = nextHopGateIds[r*numDests+d];
+                if (outputGateId==-1)
+                    continue; // not connected
+                target.ie = ift->getInterfaceByNodeOutputGateId(outputGateId);
+                if (!target.ie)
+                    error("%s has no interface for output gate id %d", ift->getFullPath().c_str(), outputGateId);
+            }
+            targets.push_back(target);
+        }
 
-        IPAddress destAddr = nodeInfo[i].address;
-        std::string destModName = destNode->getModule()->getFullName();
+        EV << "  adding routes to " << topo.getNode(j)->getModule()->getFullName() << "=" << nodeInfo[j].address << endl;
 
-        // calculate shortest paths from everywhere towards destNode
-        topo.calculateUnweightedSingleShortestPathsTo(destNode);
+        // aggregation needs unique addresses (which assignAddresses() ensures)
+        std::sort(targets.begin(), targets.end());
+        bool unique = true;
+        for (unsigned int k=1; k<targets.size() && unique; k++)
+            unique = targets[k].address != targets[k-1].address;
 
-        // add route (with host=destNode) to every routing table in the network
-        // (excepting nodes with only one interface -- there we'll set up a default route)
-        for (int j=0; j<topo.getNumNodes(); j++)
+        // routes already in the table (e.g. from routing files) could win
+        // against prefix routes where they would lose against host routes
+        if (aggregate && unique && hasRoutesInto(nodeInfo[j].rt, networkAddress, netmask))
         {
-            if (i==j) continue;
-            if (!nodeInfo[j].isIPNode)
-                continue;
+            EV << "    routing table already contains routes into the network, not aggregating\n";
+            unique = false;
+        }
 
-            cTopology::Node *atNode = topo.getNode(j);
-            if (atNode->getNumPaths()==0)
-                continue; // not connected
-            if (nodeInfo[j].usesDefaultRoute)
-                continue; // already added default route here
+        if (aggregate && unique)
+            addAggregatedRoutes(nodeInfo[j].rt, targets, 0, targets.size(), 0, 0, NULL);
+        else
+            addHostRoutes(nodeInfo[j].rt, targets);
+    }
+}
 
-            IPAddress atAddr = nodeInfo[j].address;
+bool FlatNetworkConfigurator::hasRoutesInto(IRoutingTable *rt, uint32 networkAddress, uint32 netmask)
+{
+    // the default route is ignored: prefix routes are more specific anyway
+    for (int k=0; k<rt->getNumRoutes(); k++)
+    {
+        const IPRoute *e = rt->getRoute(k);
+        uint32 routeNetmask = e->getNetmask().getInt();
+        if (routeNetmask!=0 && ((e->getHost().getInt() ^ networkAddress) & routeNetmask & netmask)==0)
+            return true;
+    }
+    return false;
+}
 
-            IInterfaceTable *ift = nodeInfo[j].ift;
+void FlatNetworkConfigurator::addHostRoutes(IRoutingTable *rt, const RouteTargetVector& targets)
+{
+    for (unsigned int k=0; k<targets.size(); k++)
+        if (targets[k].ie)
+            addRoute(rt, targets[k].address, 32, targets[k].ie);
+}
 
-            int outputGateId = atNode->getPath(0)->getLocalGate()->getId();
-            InterfaceEntry *ie = ift->getInterfaceByNodeOutputGateId(outputGateId);
+void FlatNetworkConfigurator::addAggregatedRoutes(IRoutingTable *rt, const RouteTargetVector& targets, int begin, int end,
+        uint32 prefix, int prefixLength, InterfaceEntry *inheritedIe)
+{
+    // targets[begin..end) are the addresses within prefix/prefixLength, sorted.
+    // A route is only added for a block if all addresses of the block are
+    // targets, so that no packet to an unused address gets routed. Within such
+    // a block, the most common interface gets the route of the block, and
+    // sub-blocks (ultimately single addresses) towards other interfaces get
+    // more specific routes.
+    if (begin==end)
+        return;
+
+    uint64 blockSize = (uint64)1 << (32-prefixLength);
+    if ((uint64)(end-begin) == blockSize)
+    {
+        // find the most common interface within the block (the node's own
+        // address may go anywhere, it is delivered locally)
+        std::vector<std::pair<InterfaceEntry *, int> > counts;
+        InterfaceEntry *bestIe = NULL;
+        int bestCount = 0;
+        for (int k=begin; k<end; k++)
+        {
+            InterfaceEntry *ie = targets[k].ie;
             if (!ie)
-                error("%s has no interface for output gate id %d", ift->getFullPath().c_str(), outputGateId);
-
-            EV << "  from " << atNode->getModule()->getFullName() << "=" << IPAddress(atAddr);
-            EV << " towards " << destModName << "=" << IPAddress(destAddr) << " interface " << ie->getName() << endl;
-
-            // add route
-            IRoutingTable *rt = nodeInfo[j].rt;
-            IPRoute *e = new IPRoute();
-            e->setHost(destAddr);
-            e->setNetmask(IPAddress(255,255,255,255)); // full match needed
-            e->setInterface(ie);
-            e->setType(IPRoute::DIRECT);
-            e->setSource(IPRoute::MANUAL);
-            //e->getMetric() = 1;
-            rt->addRoute(e);
+                continue;
+            unsigned int c;
+            for (c=0; c<counts.size() && counts[c].first!=ie; c++)
+                ;
+            if (c==counts.size())
+                counts.push_back(std::make_pair(ie, 0));
+            if (++counts[c].second > bestCount)
+            {
+                bestIe = ie;
+                bestCount = counts[c].second;
+            }
+        }
+
+        if (bestIe && bestIe!=inheritedIe)
+        {
+            addRoute(rt, prefix, prefixLength, bestIe);
+            inheritedIe = bestIe;
         }
+        if (blockSize==1)
+            return;
     }
+
+    // split the block into two halves
+    uint32 upperHalf = prefix | ((uint32)1 << (31-prefixLength));
+    RouteTarget key;
+    key.address = upperHalf;
+    int mid = std::lower_bound(targets.begin()+begin, targets.begin()+end, key) - targets.begin();
+    addAggregatedRoutes(rt, targets, begin, mid, prefix, prefixLength+1, inheritedIe);
+    addAggregatedRoutes(rt, targets, mid, end, upperHalf, prefixLength+1, inheritedIe);
+}
+
+void FlatNetworkConfigurator::addRoute(IRoutingTable *rt, uint32 prefix, int prefixLength, InterfaceEntry *ie)
+{
+    uint32 netmask = prefixLength==0 ? 0 : ~(uint32)0 << (32-prefixLength);
+
+    EV << "    towards " << IPAddress(prefix) << "/" << prefixLength << " interface " << ie->getName() << endl;
+
+    IPRoute *e = new IPRoute();
+    e->setHost(IPAddress(prefix));
+    e->setNetmask(IPAddress(netmask)); // full match needed for host routes
+    e->setInterface(ie);
+    e->setType(IPRoute::DIRECT);
+    e->setSource(IPRoute::MANUAL);
+    //e->getMetric() = 1;
+    rt->addRoute(e);
+}
+
+void FlatNetworkConfigurator::finish()
+{
+    // the CPU time differs from run to run, so it is only recorded on request
+    if (par("recordConfigurationTime").boolValue())
+        recordScalar("configuration time", configurationTime);
+    if (*par("cacheFile").stringValue())
+        recordScalar("configuration loaded from cache", loadedFromCache);
 }
 
 void FlatNetworkConfigurator::handleMessage(cMessage *msg)
@@ -24,6 +24,7 @@
 
 class IInterfaceTable;
 class IRoutingTable;
+class InterfaceEntry;
 
 
 /**
@@ -46,15 +47,33 @@ class INET_API FlatNetworkConfigurator : public cSimpleModule
     };
     typedef std::vector<NodeInfo> NodeInfoVector;
 
+    // a destination address, and the interface towards it (NULL for own address)
+    struct RouteTarget {
+        uint32 address;
+        InterfaceEntry *ie;
+        bool operator<(const RouteTarget& other) const {return address < other.address;}
+    };
+    typedef std::vector<RouteTarget> RouteTargetVector;
+
+    // statistics
+    double configurationTime;  // CPU time of the configuration, in seconds
+    bool loadedFromCache;
+
   protected:
     virtual int numInitStages() const  {return 3;}
     virtual void initialize(int stage);
     virtual void handleMessage(cMessage *msg);
+    virtual void finish();
 
     virtual void extractTopology(cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void assignAddresses(cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void addDefaultRoutes(cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void fillRoutingTables(cTopology& topo, NodeInfoVector& nodeInfo);
+    virtual bool hasRoutesInto(IRoutingTable *rt, uint32 networkAddress, uint32 netmask);
+    virtual void addHostRoutes(IRoutingTable *rt, const RouteTargetVector& targets);
+    virtual void addAggregatedRoutes(IRoutingTable *rt, const RouteTargetVector& targets, int begin, int end,
+            uint32 prefix, int prefixLength, InterfaceEntry *inheritedIe);
+    virtual void addRoute(IRoutingTable *rt, uint32 prefix, int prefixLength, InterfaceEntry *ie);
 
     virtual void setDisplayString(cTopology& topo, NodeInfoVector& nodeInfo);
 };
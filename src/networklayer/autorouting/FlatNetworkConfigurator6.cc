@@ -20,6 +20,7 @@
 #include "FlatNetworkConfigurator6.h"
 #include "IInterfaceTable.h"
 #include "IPAddressResolver.h"
+#include "UnweightedShortestPaths.h"
 #ifndef WITHOUT_IPv6
 #include "IPv6InterfaceData.h"
 #include "RoutingTable6.h"
@@ -167,28 +168,38 @@ void FlatNetworkConfigurator6::addOwnAdvPrefixRoutes(cTopology& topo)
 
 void FlatNetworkConfigurator6::addStaticRoutes(cTopology& topo)
 {
+    int numNodes = topo.getNumNodes();
     int numIPNodes = 0;
 
-    // fill in routing tables
-    for (int i = 0; i < topo.getNumNodes(); i++)
+    // look up the interface and routing tables only once per node
+    std::vector<IInterfaceTable *> ifts(numNodes, (IInterfaceTable *)NULL);  // NULL for bus types
+    std::vector<RoutingTable6 *> rts(numNodes, (RoutingTable6 *)NULL);
+    std::vector<bool> isRouter(numNodes, false);
+    for (int i = 0; i < numNodes; i++)
     {
-        cTopology::Node *destNode = topo.getNode(i);
+        cTopology::Node *node = topo.getNode(i);
+        if (!isIPNode(node))
+            continue;
+        numIPNodes++; // FIXME split into num hosts, num routers
+        ifts[i] = IPAddressResolver().interfaceTableOf(node->getModule());
+        rts[i] = IPAddressResolver().routingTable6Of(node->getModule());
+        isRouter[i] = rts[i]->par("isRouter").boolValue();
+    }
 
-        // skip bus types
-        if (!isIPNode(destNode))
+    UnweightedShortestPaths paths(topo);
+
+    // fill in routing tables
+    for (int i = 0; i < numNodes; i++)
+    {
+        // skip bus types, and don't add routes towards hosts
+        if (!ifts[i] || !isRouter[i])
             continue;
 /*
     void addOrUpdateOwnAdvPrefix(const IPv6Address& destPrefix, int prefixLength,
                                  int interfaceId, simtime_t expiryTime);
 */
 
-        numIPNodes++; // FIXME split into num hosts, num routers
-        RoutingTable6 *destRt = IPAddressResolver().routingTable6Of(destNode->getModule());
-        IInterfaceTable *destIft = IPAddressResolver().interfaceTableOf(destNode->getModule());
-
-        // don't add routes towards hosts
-        if (!destRt->par("isRouter").boolValue())
-            continue;
+        IInterfaceTable *destIft = ifts[i];
 
         // get a list of globally routable prefixes from the dest node
         std::vector<const IPv6InterfaceData::AdvPrefix*> destPrefixes;
@@ -204,48 +215,35 @@ void FlatNetworkConfigurator6::addStaticRoutes(cTopology& topo)
                     destPrefixes.push_back(&destIf->ipv6Data()->getAdvPrefix(y));
         }
 
-        std::string destModName = destNode->getModule()->getFullName();
-
         // calculate shortest paths from everywhere towards destNode
-        topo.calculateUnweightedSingleShortestPathsTo(destNode);
+        paths.calculatePathsTo(i);
 
         // add route (with dest=destPrefixes) to every router routing table in the network
-        for (int j = 0; j < topo.getNumNodes(); j++)
+        for (int j = 0; j < numNodes; j++)
         {
             if (i == j)
                 continue;
-            if (!isIPNode(topo.getNode(j)))
+            // skip bus types and hosts' routing tables
+            if (!ifts[j] || !isRouter[j])
                 continue;
-
-            cTopology::Node *atNode = topo.getNode(j);
-            if (atNode->getNumPaths() == 0)
+            if (!paths.hasPath(j))
                 continue;       // not connected
 
-            RoutingTable6 *rt = IPAddressResolver().routingTable6Of(atNode->getModule());
-            IInterfaceTable *ift = IPAddressResolver().interfaceTableOf(atNode->getModule());
-
-            // skip hosts' routing tables
-            if (!rt->par("isRouter").boolValue())
-                continue;
-
             // determine the local interface id
-            cGate *localGate = atNode->getPath(0)->getLocalGate();
-            InterfaceEntry *localIf = ift->getInterfaceByNodeOutputGateId(localGate->getId());
+            InterfaceEntry *localIf = ifts[j]->getInterfaceByNodeOutputGateId(paths.getOutputGateId(j));
 
             // determine next hop link address. That's a bit tricky because
             // the directly adjacent cTopo node might be a non-IP getNode(ethernet switch etc)
             // so we have to "seek through" them.
-            cTopology::Node *prevNode = atNode;
+            int prevNode = j;
             // if there's no ethernet switch between atNode and it's next hop
             // neighbour, we don't go into the following while() loop
-            while (!isIPNode(prevNode->getPath(0)->getRemoteNode()))
-                prevNode = prevNode->getPath(0)->getRemoteNode();
+            while (!ifts[paths.getNextNode(prevNode)])
+                prevNode = paths.getNextNode(prevNode);
 
             // ok, the next hop is now just one step away from prevNode
-            cGate *remoteGate = prevNode->getPath(0)->getRemoteGate();
-            cModule *nextHop = remoteGate->getOwnerModule();
-            IInterfaceTable *nextHopIft = IPAddressResolver().interfaceTableOf(nextHop);
-            InterfaceEntry *nextHopOnlinkIf = nextHopIft->getInterfaceByNodeInputGateId(remoteGate->getId());
+            int nextHop = paths.getNextNode(prevNode);
+            InterfaceEntry *nextHopOnlinkIf = ifts[nextHop]->getInterfaceByNodeInputGateId(paths.getNextNodeInputGateId(prevNode));
 
             // find link-local address for next hop
             IPv6Address nextHopLinkLocalAddr = nextHopOnlinkIf->ipv6Data()->getLinkLocalAddress();
@@ -254,14 +252,14 @@ void FlatNetworkConfigurator6::addStaticRoutes(cTopology& topo)
             // add to route table
             for (unsigned int k = 0; k < destPrefixes.size(); k++)
             {
-                rt->addStaticRoute(destPrefixes[k]->prefix, destPrefixes[k]->prefixLength,
-                                   localIf->getInterfaceId(), nextHopLinkLocalAddr);
+                rts[j]->addStaticRoute(destPrefixes[k]->prefix, destPrefixes[k]->prefixLength,
+                                       localIf->getInterfaceId(), nextHopLinkLocalAddr);
             }
         }
     }
 
     // update display string
-    setDisplayString(numIPNodes, topo.getNumNodes()-numIPNodes);
+    setDisplayString(numIPNodes, numNodes-numIPNodes);
 }
 #endif
 
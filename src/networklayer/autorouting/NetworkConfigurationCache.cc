@@ -0,0 +1,332 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#if defined(_WIN32)
+#include <process.h>  // getpid()
+#else
+#include <unistd.h>   // getpid()
+#endif
+#include "NetworkConfigurationCache.h"
+#include "IInterfaceTable.h"
+#include "IRoutingTable.h"
+#include "IPv4InterfaceData.h"
+
+// file layout (all numbers are 32-bit big endian):
+//   magic, hash (2 words), number of nodes, then for each node:
+//   routerId, number of interfaces, {interfaceId, address, netmask}...,
+//   number of routes, {host, netmask, gateway, interfaceId, type, source, metric}...
+static const char MAGIC[8] = {'I','N','E','T','N','C','C','1'};
+
+// FNV-1a
+static void hashBytes(uint64& h, const unsigned char *data, size_t length)
+{
+    for (size_t i=0; i<length; i++)
+    {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+static void hashValue(uint64& h, uint32 value)
+{
+    unsigned char buf[4] = {(unsigned char)(value>>24), (unsigned char)(value>>16), (unsigned char)(value>>8), (unsigned char)value};
+    hashBytes(h, buf, 4);
+}
+
+static void hashString(uint64& h, const char *s)
+{
+    hashBytes(h, (const unsigned char *)s, strlen(s)+1);
+}
+
+static void writeValue(std::ostream& os, uint32 value)
+{
+    char buf[4] = {(char)(value>>24), (char)(value>>16), (char)(value>>8), (char)value};
+    os.write(buf, 4);
+}
+
+static bool readValue(std::istream& is, uint32& value)
+{
+    unsigned char buf[4];
+    if (!is.read((char *)buf, 4))
+        return false;
+    value = ((uint32)buf[0]<<24) | ((uint32)buf[1]<<16) | ((uint32)buf[2]<<8) | (uint32)buf[3];
+    return true;
+}
+
+NetworkConfigurationCache::NetworkConfigurationCache()
+{
+    hash = 14695981039346656037ULL;
+}
+
+void NetworkConfigurationCache::addNode(cTopology::Node *node, IInterfaceTable *ift, IRoutingTable *rt)
+{
+    nodes.push_back(NodeEntry());
+    NodeEntry& entry = nodes.back();
+    entry.node = node;
+    entry.ift = ift;
+    entry.rt = ift ? rt : NULL;
+
+    // hash the node as it is before the configuration
+    hashString(hash, node->getModule()->getFullPath().c_str());
+
+    // links
+    hashValue(hash, node->getNumOutLinks());
+    for (int j=0; j<node->getNumOutLinks(); j++)
+    {
+        cTopology::LinkOut *link = node->getLinkOut(j);
+        hashString(hash, link->getRemoteNode()->getModule()->getFullPath().c_str());
+        hashValue(hash, link->getLocalGate()->getId());
+        hashValue(hash, link->getRemoteGate()->getId());
+    }
+
+    // interfaces
+    hashValue(hash, ift ? ift->getNumInterfaces() : -1);
+    for (int k=0; ift && k<ift->getNumInterfaces(); k++)
+    {
+        InterfaceEntry *ie = ift->getInterface(k);
+        hashValue(hash, ie->getInterfaceId());
+        hashString(hash, ie->getName());
+        hashValue(hash, ie->getNodeInputGateId());
+        hashValue(hash, ie->getNodeOutputGateId());
+        hashValue(hash, ie->isLoopback());
+    }
+
+    // preconfigured router id and routes
+    hashValue(hash, entry.rt ? entry.rt->getNumRoutes() : -1);
+    if (entry.rt)
+    {
+        hashValue(hash, rt->getRouterId().getInt());
+        for (int k=0; k<rt->getNumRoutes(); k++)
+        {
+            const IPRoute *route = rt->getRoute(k);
+            entry.oldRoutes.insert(route);
+            hashValue(hash, route->getHost().getInt());
+            hashValue(hash, route->getNetmask().getInt());
+            hashValue(hash, route->getGateway().getInt());
+            hashValue(hash, route->getInterface() ? route->getInterface()->getInterfaceId() : -1);
+        }
+    }
+}
+
+void NetworkConfigurationCache::addParameter(cPar& par)
+{
+    hashString(hash, par.getFullName());
+    hashString(hash, par.str().c_str());
+}
+
+bool NetworkConfigurationCache::readFile(const char *fileName, std::vector<NodeConfig>& config) const
+{
+    std::ifstream in(fileName, std::ios::in|std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC))!=0)
+        return false;
+
+    uint32 hashHigh, hashLow, numNodes;
+    if (!readValue(in, hashHigh) || !readValue(in, hashLow) || !readValue(in, numNodes))
+        return false;
+    if (hashHigh!=(uint32)(hash>>32) || hashLow!=(uint32)hash || numNodes!=nodes.size())
+        return false;
+
+    config.resize(numNodes);
+    for (uint32 i=0; i<numNodes; i++)
+    {
+        NodeConfig& nodeConfig = config[i];
+        uint32 numInterfaces, numRoutes;
+        if (!readValue(in, nodeConfig.routerId) || !readValue(in, numInterfaces))
+            return false;
+        for (uint32 k=0; k<numInterfaces; k++)
+        {
+            InterfaceConfig ic;
+            uint32 id;
+            if (!readValue(in, id) || !readValue(in, ic.address) || !readValue(in, ic.netmask))
+                return false;
+            ic.interfaceId = id;
+            nodeConfig.interfaces.push_back(ic);
+        }
+        if (!readValue(in, numRoutes))
+            return false;
+        for (uint32 k=0; k<numRoutes; k++)
+        {
+            RouteConfig rc;
+            uint32 id, type, source, metric;
+            if (!readValue(in, rc.host) || !readValue(in, rc.netmask) || !readValue(in, rc.gateway) ||
+                !readValue(in, id) || !readValue(in, type) || !readValue(in, source) || !readValue(in, metric))
+                return false;
+            rc.interfaceId = id;
+            rc.type = type;
+            rc.source = source;
+            rc.metric = metric;
+            nodeConfig.routes.push_back(rc);
+        }
+    }
+    return true;
+}
+
+bool NetworkConfigurationCache::isApplicable(const std::vector<NodeConfig>& config) const
+{
+    // the hash covers the interfaces, but check anyway that every id can be
+    // resolved, so that a damaged file cannot leave the network half-configured
+    for (int i=0; i<(int)nodes.size(); i++)
+    {
+        const NodeEntry& entry = nodes[i];
+        const NodeConfig& nodeConfig = config[i];
+        if (!entry.ift && !nodeConfig.interfaces.empty())
+            return false;
+        if (!entry.rt && !nodeConfig.routes.empty())
+            return false;
+        for (int k=0; k<(int)nodeConfig.interfaces.size(); k++)
+        {
+            InterfaceEntry *ie = entry.ift->getInterfaceById(nodeConfig.interfaces[k].interfaceId);
+            if (!ie || !ie->ipv4Data())
+                return false;
+        }
+        for (int k=0; k<(int)nodeConfig.routes.size(); k++)
+        {
+            int id = nodeConfig.routes[k].interfaceId;
+            if (id!=-1 && !entry.ift->getInterfaceById(id))
+                return false;
+        }
+    }
+    return true;
+}
+
+void NetworkConfigurationCache::apply(const std::vector<NodeConfig>& config)
+{
+    for (int i=0; i<(int)nodes.size(); i++)
+    {
+        const NodeEntry& entry = nodes[i];
+        const NodeConfig& nodeConfig = config[i];
+        for (int k=0; k<(int)nodeConfig.interfaces.size(); k++)
+        {
+            const InterfaceConfig& ic = nodeConfig.interfaces[k];
+            IPv4InterfaceData *d = entry.ift->getInterfaceById(ic.interfaceId)->ipv4Data();
+            d->setIPAddress(IPAddress(ic.address));
+            d->setNetmask(IPAddress(ic.netmask));
+        }
+        if (!entry.rt)
+            continue;
+        if (nodeConfig.routerId!=0)
+            entry.rt->setRouterId(IPAddress(nodeConfig.routerId));
+        for (int k=0; k<(int)nodeConfig.routes.size(); k++)
+        {
+            const RouteConfig& rc = nodeConfig.routes[k];
+            IPRoute *e = new IPRoute();
+            e->setHost(IPAddress(rc.host));
+            e->setNetmask(IPAddress(rc.netmask));
+            e->setGateway(IPAddress(rc.gateway));
+            e->setInterface(rc.interfaceId==-1 ? NULL : entry.ift->getInterfaceById(rc.interfaceId));
+            e->setType((IPRoute::RouteType)rc.type);
+            e->setSource((IPRoute::RouteSource)rc.source);
+            e->setMetric(rc.metric);
+            entry.rt->addRoute(e);
+        }
+    }
+}
+
+bool NetworkConfigurationCache::load(const char *fileName)
+{
+    std::vector<NodeConfig> config;
+    if (!readFile(fileName, config) || !isApplicable(config))
+        return false;
+    apply(config);
+    return true;
+}
+
+void NetworkConfigurationCache::save(const char *fileName)
+{
+    // Write into a temporary file, then rename it. This way runs that start
+    // at the same time (e.g. in a parameter study) never see a partially
+    // written file: they either read the old file or the new one. The
+    // process id keeps the temporary files of concurrent runs apart.
+    std::stringstream tmpName;
+    tmpName << fileName << "." << getpid() << ".tmp";
+    std::string tmpFileName = tmpName.str();
+
+    std::ofstream out(tmpFileName.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+    if (!out.is_open())
+        throw cRuntimeError("Cannot open network configuration cache file `%s' for writing", tmpFileName.c_str());
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeValue(out, (uint32)(hash>>32));
+    writeValue(out, (uint32)hash);
+    writeValue(out, nodes.size());
+    for (int i=0; i<(int)nodes.size(); i++)
+    {
+        const NodeEntry& entry = nodes[i];
+        IInterfaceTable *ift = entry.ift;
+        IRoutingTable *rt = entry.rt;
+
+        writeValue(out, rt ? rt->getRouterId().getInt() : 0);
+
+        int numInterfaces = 0;
+        for (int k=0; ift && k<ift->getNumInterfaces(); k++)
+            if (!ift->getInterface(k)->isLoopback() && ift->getInterface(k)->ipv4Data())
+                numInterfaces++;
+        writeValue(out, numInterfaces);
+        for (int k=0; ift && k<ift->getNumInterfaces(); k++)
+        {
+            InterfaceEntry *ie = ift->getInterface(k);
+            if (ie->isLoopback() || !ie->ipv4Data())
+                continue;
+            writeValue(out, ie->getInterfaceId());
+            writeValue(out, ie->ipv4Data()->getIPAddress().getInt());
+            writeValue(out, ie->ipv4Data()->getNetmask().getInt());
+        }
+
+        // only the routes added by the configurator
+        std::vector<const IPRoute *> routes;
+        for (int k=0; rt && k<rt->getNumRoutes(); k++)
+            if (entry.oldRoutes.find(rt->getRoute(k))==entry.oldRoutes.end())
+                routes.push_back(rt->getRoute(k));
+        writeValue(out, routes.size());
+        for (int k=0; k<(int)routes.size(); k++)
+        {
+            const IPRoute *route = routes[k];
+            writeValue(out, route->getHost().getInt());
+            writeValue(out, route->getNetmask().getInt());
+            writeValue(out, route->getGateway().getInt());
+            writeValue(out, route->getInterface() ? route->getInterface()->getInterfaceId() : -1);
+            writeValue(out, route->getType());
+            writeValue(out, route->getSource());
+            writeValue(out, route->getMetric());
+        }
+    }
+
+    out.close();
+    if (out.fail())
+    {
+        remove(tmpFileName.c_str());
+        throw cRuntimeError("Error writing network configuration cache file `%s'", tmpFileName.c_str());
+    }
+
+#if defined(_WIN32)
+    remove(fileName);  // rename() does not replace existing files on Windows
+#endif
+    if (rename(tmpFileName.c_str(), fileName) != 0)
+    {
+        remove(tmpFileName.c_str());
+        throw cRuntimeError("Cannot rename `%s' to network configuration cache file `%s'", tmpFileName.c_str(), fileName);
+    }
+}
+
@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_NETWORKCONFIGURATIONCACHE_H
+#define __INET_NETWORKCONFIGURATIONCACHE_H
+
+#include <vector>
+#include <set>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+class IInterfaceTable;
+class IRoutingTable;
+class IPRoute;
+
+
+/**
+ * Stores the result of a network configurator run (interface addresses,
+ * router ids and the routes it added) in a binary file, so that later runs
+ * of the same network can load it instead of computing it again.
+ *
+ * The file is keyed by a hash of the topology: the node modules, their
+ * links and interfaces, the router ids and routes present before the
+ * configuration, and the configurator parameters passed to addParameter().
+ * If any of these change, the file is ignored and rewritten.
+ *
+ * Usage: call addNode() for every node of the cTopology (in index order)
+ * and addParameter() for the parameters that affect the configuration,
+ * before the configurator changes anything. Then call load(); if it
+ * returns false, configure the network as usual and call save().
+ */
+class INET_API NetworkConfigurationCache
+{
+  protected:
+    struct NodeEntry {
+        cTopology::Node *node;
+        IInterfaceTable *ift;  // NULL for non-IP nodes
+        IRoutingTable *rt;     // NULL for non-IP nodes
+        std::set<const IPRoute *> oldRoutes;  // routes present before the configuration
+    };
+
+    struct InterfaceConfig {
+        int interfaceId;
+        uint32 address;
+        uint32 netmask;
+    };
+
+    struct RouteConfig {
+        uint32 host;
+        uint32 netmask;
+        uint32 gateway;
+        int interfaceId;  // -1 if none
+        int type;
+        int source;
+        int metric;
+    };
+
+    struct NodeConfig {
+        uint32 routerId;
+        std::vector<InterfaceConfig> interfaces;
+        std::vector<RouteConfig> routes;
+    };
+
+    std::vector<NodeEntry> nodes;
+    uint64 hash;  // of the nodes and parameters added so far
+
+  protected:
+    bool readFile(const char *fileName, std::vector<NodeConfig>& config) const;
+    bool isApplicable(const std::vector<NodeConfig>& config) const;
+    void apply(const std::vector<NodeConfig>& config);
+
+  public:
+    NetworkConfigurationCache();
+
+    /**
+     * Adds the next node of the topology; ift and rt are NULL for nodes
+     * that are not configured (e.g. Ethernet switches).
+     */
+    void addNode(cTopology::Node *node, IInterfaceTable *ift, IRoutingTable *rt);
+
+    /**
+     * Adds a parameter the configuration depends on to the hash.
+     */
+    void addParameter(cPar& par);
+
+    /**
+     * Configures the nodes from the file if it exists and was saved for
+     * the same topology and parameters, and returns true; returns false
+     * (without changing anything) otherwise.
+     */
+    bool load(const char *fileName);
+
+    /**
+     * Writes the configuration of the nodes into the file. The file is
+     * written under a temporary name first and then renamed, so readers
+     * never see a partially written file. Throws an error if the file
+     * cannot be written.
+     */
+    void save(const char *fileName);
+};
+
+#endif
+
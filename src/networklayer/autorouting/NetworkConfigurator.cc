@@ -16,11 +16,18 @@
 //
 
 #include <algorithm>
+#include <map>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "IRoutingTable.h"
 #include "IInterfaceTable.h"
 #include "IPAddressResolver.h"
 #include "NetworkConfigurator.h"
 #include "IPv4InterfaceData.h"
+#include "UnweightedShortestPaths.h"
+#include "NetworkConfigurationCache.h"
 
 
 Define_Module(NetworkConfigurator);
@@ -30,6 +37,18 @@ void NetworkConfigurator::initialize(int stage)
 {
     if (stage==2)
     {
+        numThreads = par("numThreads");
+        if (numThreads < 0)
+            error("invalid numThreads parameter %d", numThreads);
+#ifdef _OPENMP
+        if (numThreads==0)
+            numThreads = omp_get_num_procs();
+#else
+        numThreads = 1;
+#endif
+
+        clock_t startTime = clock();
+
         cTopology topo("topo");
         NodeInfoVector nodeInfo; // will be of size topo.nodes[]
 
@@ -37,22 +56,49 @@ void NetworkConfigurator::initialize(int stage)
         // isIPNode, rt and ift members of nodeInfo[]
         extractTopology(topo, nodeInfo);
 
-        // assign addresses to IP nodes, and also store result in nodeInfo[].address
-        assignAddresses(topo, nodeInfo);
+        // load the configuration from the cache file if it was saved for the same network
+        const char *cacheFile = par("cacheFile");
+        NetworkConfigurationCache cache;
+        bool loaded = false;
+        if (*cacheFile)
+        {
+            for (int i=0; i<topo.getNumNodes(); i++)
+                cache.addNode(topo.getNode(i), nodeInfo[i].isIPNode ? nodeInfo[i].ift : NULL, nodeInfo[i].rt);
+            cache.addParameter(par("addStaticRoutes"));
+            loaded = cache.load(cacheFile);
+        }
+
+        if (!loaded)
+        {
+            // assign addresses to IP nodes, and also store result in nodeInfo[].address
+            assignAddresses(topo, nodeInfo);
 
-        // add routes for point-to-point peers
-        addPointToPointPeerRoutes(topo, nodeInfo);
+            // add routes for point-to-point peers
+            addPointToPointPeerRoutes(topo, nodeInfo);
 
-        // add default routes to hosts (nodes with a single attachment);
-        // also remember result in nodeInfo[].usesDefaultRoute
-        addDefaultRoutes(topo, nodeInfo);
+            // add default routes to hosts (nodes with a single attachment);
+            // also remember result in nodeInfo[].usesDefaultRoute
+            addDefaultRoutes(topo, nodeInfo);
+        }
 
         // help configure RSVP and LinkStateRouting modules by setting their "peers" parameters
         setPeersParameter("rsvp", topo, nodeInfo);
         setPeersParameter("linkStateRouting", topo, nodeInfo);
 
-        // calculate shortest paths, and add corresponding static routes
-        fillRoutingTables(topo, nodeInfo);
+        if (!loaded)
+        {
+            // calculate shortest paths, and add corresponding static routes
+            if (par("addStaticRoutes").boolValue())
+                fillRoutingTables(topo, nodeInfo);
+
+            if (*cacheFile)
+                cache.save(cacheFile);
+        }
+
+        configurationTime = (double)(clock()-startTime)/CLOCKS_PER_SEC;
+        loadedFromCache = loaded;
+        EV << "network configured in " << configurationTime << "s"
+           << (!*cacheFile ? "" : loaded ? ", loaded from " : ", saved to ") << cacheFile << endl;
 
         // update display string
         setDisplayString(topo, nodeInfo);
@@ -88,6 +134,7 @@ void NetworkConfigurator::assignAddresses(cTopology& topo, NodeInfoVector& nodeI
             continue;
 
         uint32 addr = base + (nodeCtr++ << 8);   // --> 10.nn.nn.0
+        nodeInfo[i].address = IPAddress(addr);
 
         // assign address to all (non-loopback) interfaces
         IInterfaceTable *ift = nodeInfo[i].ift;
@@ -114,6 +161,11 @@ void NetworkConfigurator::addPointToPointPeerRoutes(cTopology& topo, NodeInfoVec
 {
     bool useRouterIdForRoutes = true; // TODO make it parameter
 
+    // cTopology index of the nodes
+    std::map<cTopology::Node *, int> nodeIndex;
+    for (int i=0; i<topo.getNumNodes(); i++)
+        nodeIndex[topo.getNode(i)] = i;
+
     // add routes towards point-to-point routers (in real life these routes are
     // created automatically after PPP handshake when neighbour's address is learned)
     for (int i=0; i<topo.getNumNodes(); i++)
@@ -132,11 +184,9 @@ void NetworkConfigurator::addPointToPointPeerRoutes(cTopology& topo, NodeInfoVec
             cTopology::Node *neighbor = node->getLinkOut(j)->getRemoteNode();
 
             // find neighbour's index in cTopology ==> k
-            int k;
-            for (k=0; k<topo.getNumNodes(); k++)
-                if (topo.getNode(k)==neighbor)
-                    break;
-            ASSERT(k<=topo.getNumNodes());
+            std::map<cTopology::Node *, int>::iterator it = nodeIndex.find(neighbor);
+            ASSERT(it!=nodeIndex.end());
+            int k = it->second;
 
             // if it's not an IP getNode(e.g. an Ethernet switch), then we're not interested
             if (!nodeInfo[k].isIPNode)
@@ -256,62 +306,151 @@ void NetworkConfigurator::setPeersParameter(const char *submodName, cTopology& t
 
 void NetworkConfigurator::fillRoutingTables(cTopology& topo, NodeInfoVector& nodeInfo)
 {
-/* FIXME TBD
-    // fill in routing tables with static routes
-    for (int i=0; i<topo.getNumNodes(); i++)
+    // every IP node is a destination; routes are added to the IP nodes
+    // which don't use a default route
+    int numNodes = topo.getNumNodes();
+    std::vector<char> isIPNode(numNodes);
+    std::vector<int> destNodes, atNodes;
+    for (int i=0; i<numNodes; i++)
     {
-        cTopology::Node *destNode = topo.getNode(i);
-
-        // skip bus types
+        isIPNode[i] = nodeInfo[i].isIPNode;
         if (!nodeInfo[i].isIPNode)
             continue;
+        destNodes.push_back(i);
+        if (!nodeInfo[i].usesDefaultRoute)
+            atNodes.push_back(i);
+    }
+    if (atNodes.empty())
+        return;
 
-        IPAddress destAddr = nodeInfo[i].address;
-        std::string destModName = destNode->getModule()->getFullName();
+    EV << "calculating paths towards " << destNodes.size() << " nodes, using " << numThreads << " thread(s)\n";
 
-        // calculate shortest paths from everywhere towards destNode
-        topo.calculateUnweightedSingleShortestPathsTo(destNode);
+    // one copy of the graph per thread
+    std::vector<UnweightedShortestPaths> paths(numThreads, UnweightedShortestPaths(topo));
 
-        // add route (with host=destNode) to every routing table in the network
-        // (excepting nodes with only one interface -- there we'll set up a default route)
-        for (int j=0; j<topo.getNumNodes(); j++)
+    // the next hops are calculated in parallel for a batch of destinations,
+    // then the routes are added here; this bounds the memory needed for
+    // the results, and keeps the routing tables out of the worker threads
+    int numDests = destNodes.size();
+    int batchSize = 16 * numThreads;
+    NextHopVector nextHops(batchSize * atNodes.size());
+    for (int first=0; first<numDests; first+=batchSize)
+    {
+        int n = std::min(batchSize, numDests-first);
+        calculateNextHops(paths, isIPNode, atNodes, &destNodes[first], n, nextHops);
+        for (int k=0; k<n; k++)
+            addRoutesTowards(destNodes[first+k], nodeInfo, atNodes, &nextHops[k * atNodes.size()]);
+    }
+}
+
+void NetworkConfigurator::calculateNextHops(std::vector<UnweightedShortestPaths>& paths, const std::vector<char>& isIPNode,
+                                            const std::vector<int>& atNodes, const int *destNodes, int numDests, NextHopVector& nextHops)
+{
+    // NOTE: this runs on several threads at once, so it must not touch
+    // modules, cTopology, nor call EV or error()
+    int numAtNodes = atNodes.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads) if (numThreads > 1)
+#endif
+    for (int k=0; k<numDests; k++)
+    {
+#ifdef _OPENMP
+        UnweightedShortestPaths& sp = paths[omp_get_thread_num()];
+#else
+        UnweightedShortestPaths& sp = paths[0];
+#endif
+        int destNode = destNodes[k];
+        sp.calculatePathsTo(destNode);
+
+        NextHop *row = &nextHops[k * numAtNodes];
+        for (int a=0; a<numAtNodes; a++)
         {
-            if (i==j) continue;
-            if (!nodeInfo[j].isIPNode)
+            int j = atNodes[a];
+            NextHop& nextHop = row[a];
+            if (j==destNode || !sp.hasPath(j))
+            {
+                nextHop.node = -1;  // not connected
                 continue;
+            }
 
-            cTopology::Node *atNode = topo.getNode(j);
-            if (atNode->getNumPaths()==0)
-                continue; // not connected
-            if (nodeInfo[j].usesDefaultRoute)
-                continue; // already added default route here
+            // skip non-IP nodes (e.g. Ethernet switches) on the path
+            int prev = j;
+            int next = sp.getNextNode(j);
+            while (!isIPNode[next])
+            {
+                prev = next;
+                next = sp.getNextNode(next);
+            }
+            nextHop.outputGateId = sp.getOutputGateId(j);
+            nextHop.node = next;
+            nextHop.inputGateId = sp.getNextNodeInputGateId(prev);
+        }
+    }
+}
 
-            IPAddress atAddr = nodeInfo[j].address;
+void NetworkConfigurator::addRoutesTowards(int destNode, NodeInfoVector& nodeInfo, const std::vector<int>& atNodes, const NextHop *nextHops)
+{
+    // the interfaces of destNode are 10.nn.nn.k, so one route to 10.nn.nn.0/24
+    // covers all of them; the router id only needs a separate route if it
+    // was configured to something else
+    const NodeInfo& dest = nodeInfo[destNode];
+    IPAddress netmask(255,255,255,0);
+    IPAddress routerId = dest.rt->getRouterId();
+    bool addRouterIdRoute = !routerId.isUnspecified() && !IPAddress::maskedAddrAreEqual(routerId, dest.address, netmask);
+
+    int numRoutes = 0;
+    for (int a=0; a<(int)atNodes.size(); a++)
+    {
+        const NextHop& nextHop = nextHops[a];
+        if (nextHop.node == -1)
+            continue; // not connected, or destNode itself
 
-            IInterfaceTable *ift = nodeInfo[j].ift;
+        NodeInfo& at = nodeInfo[atNodes[a]];
+        InterfaceEntry *ie = at.ift->getInterfaceByNodeOutputGateId(nextHop.outputGateId);
+        if (!ie)
+            error("%s has no interface for output gate id %d", at.ift->getFullPath().c_str(), nextHop.outputGateId);
 
-            int outputGateId = atNode->getPath(0)->getLocalGate()->getId();
-            InterfaceEntry *ie = ift->getInterfaceByNodeOutputGateId(outputGateId);
-            if (!ie)
-                error("%s has no interface for output gate id %d", ift->getFullPath().c_str(), outputGateId);
+        IInterfaceTable *nextHopIft = nodeInfo[nextHop.node].ift;
+        InterfaceEntry *nextHopIe = nextHopIft->getInterfaceByNodeInputGateId(nextHop.inputGateId);
+        if (!nextHopIe)
+            error("%s has no interface for input gate id %d", nextHopIft->getFullPath().c_str(), nextHop.inputGateId);
+        IPAddress gateway = nextHopIe->ipv4Data()->getIPAddress();
 
-            EV << "  from " << atNode->getModule()->getFullName() << "=" << IPAddress(atAddr);
-            EV << " towards " << destModName << "=" << IPAddress(destAddr) << " interface " << ie->getName() << endl;
+        // add route
+        IPRoute *e = new IPRoute();
+        e->setHost(dest.address);
+        e->setNetmask(netmask);
+        e->setGateway(gateway);
+        e->setInterface(ie);
+        e->setType(IPRoute::REMOTE);
+        e->setSource(IPRoute::MANUAL);
+        at.rt->addRoute(e);
+        numRoutes++;
 
-            // add route
-            IRoutingTable *rt = nodeInfo[j].rt;
-            IPRoute *e = new IPRoute();
-            e->setHost(destAddr);
-            e->gateway = ???
-            e->setNetmask(IPAddress(255,255,255,255)); // full match needed
+        if (addRouterIdRoute)
+        {
+            e = new IPRoute();
+            e->setHost(routerId);
+            e->setNetmask(IPAddress::ALLONES_ADDRESS);
+            e->setGateway(gateway);
             e->setInterface(ie);
             e->setType(IPRoute::REMOTE);
             e->setSource(IPRoute::MANUAL);
-            //e->getMetric() = 1;
-            rt->addRoute(e);
+            at.rt->addRoute(e);
         }
     }
-*/
+
+    EV << "  added " << numRoutes << " routes towards " << dest.address << "/24\n";
+}
+
+void NetworkConfigurator::finish()
+{
+    // the CPU time differs from run to run, so it is only recorded on request
+    if (par("recordConfigurationTime").boolValue())
+        recordScalar("configuration time", configurationTime);
+    if (*par("cacheFile").stringValue())
+        recordScalar("configuration loaded from cache", loadedFromCache);
 }
 
 void NetworkConfigurator::handleMessage(cMessage *msg)
@@ -24,6 +24,7 @@
 
 class IInterfaceTable;
 class IRoutingTable;
+class UnweightedShortestPaths;
 
 
 /**
@@ -34,18 +35,34 @@ class INET_API NetworkConfigurator : public cSimpleModule
 {
   protected:
     struct NodeInfo {
-        NodeInfo() {isIPNode=false;ift=NULL;rt=NULL;}
+        NodeInfo() {isIPNode=false;ift=NULL;rt=NULL;usesDefaultRoute=false;}
         bool isIPNode;
         IInterfaceTable *ift;
         IRoutingTable *rt;
+        IPAddress address;   // 10.nn.nn.0, the interfaces are numbered within this /24
         bool usesDefaultRoute;
     };
     typedef std::vector<NodeInfo> NodeInfoVector;
 
+    // first hop from a node towards a destination, in cTopology indices
+    struct NextHop {
+        int outputGateId;    // gate of the node where the path leaves
+        int node;            // next IP node on the path (non-IP nodes are skipped), -1 if no path
+        int inputGateId;     // gate of the next IP node where the path enters
+    };
+    typedef std::vector<NextHop> NextHopVector;
+
+    int numThreads;
+
+    // statistics
+    double configurationTime;  // CPU time of the configuration, in seconds
+    bool loadedFromCache;
+
   protected:
     virtual int numInitStages() const  {return 3;}
     virtual void initialize(int stage);
     virtual void handleMessage(cMessage *msg);
+    virtual void finish();
 
     virtual void extractTopology(cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void assignAddresses(cTopology& topo, NodeInfoVector& nodeInfo);
@@ -53,6 +70,9 @@ class INET_API NetworkConfigurator : public cSimpleModule
     virtual void addDefaultRoutes(cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void setPeersParameter(const char *submodName, cTopology& topo, NodeInfoVector& nodeInfo);
     virtual void fillRoutingTables(cTopology& topo, NodeInfoVector& nodeInfo);
+    virtual void calculateNextHops(std::vector<UnweightedShortestPaths>& paths, const std::vector<char>& isIPNode,
+                                   const std::vector<int>& atNodes, const int *destNodes, int numDests, NextHopVector& nextHops);
+    virtual void addRoutesTowards(int destNode, NodeInfoVector& nodeInfo, const std::vector<int>& atNodes, const NextHop *nextHops);
 
     virtual void setDisplayString(cTopology& topo, NodeInfoVector& nodeInfo);
 };
@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <map>
+#include <algorithm>
+#include "UnweightedShortestPaths.h"
+
+
+UnweightedShortestPaths::UnweightedShortestPaths(cTopology& topo)
+{
+    int numNodes = topo.getNumNodes();
+
+    std::map<cTopology::Node *, int> nodeIndex;
+    for (int i=0; i<numNodes; i++)
+        nodeIndex[topo.getNode(i)] = i;
+
+    inLinkStart.resize(numNodes+1);
+    for (int i=0; i<numNodes; i++)
+    {
+        inLinkStart[i] = (int)linkSrcNode.size();
+        cTopology::Node *node = topo.getNode(i);
+        if (!node->isEnabled())
+            continue;
+        for (int k=0; k<node->getNumInLinks(); k++)
+        {
+            cTopology::LinkIn *link = node->getLinkIn(k);
+            if (!link->isEnabled() || !link->getRemoteNode()->isEnabled())
+                continue;
+            linkSrcNode.push_back(nodeIndex[link->getRemoteNode()]);
+            linkSrcGateId.push_back(link->getRemoteGate()->getId());
+            linkDestNode.push_back(i);
+            linkDestGateId.push_back(link->getLocalGate()->getId());
+        }
+    }
+    inLinkStart[numNodes] = (int)linkSrcNode.size();
+
+    target = -1;
+    dist.resize(numNodes, -1);
+    outLink.resize(numNodes, -1);
+    queue.resize(numNodes);
+}
+
+void UnweightedShortestPaths::calculatePathsTo(int target)
+{
+    ASSERT(target>=0 && target<getNumNodes());
+    this->target = target;
+    std::fill(dist.begin(), dist.end(), -1);
+    std::fill(outLink.begin(), outLink.end(), -1);
+
+    // breadth-first search from the target backwards, along the in-links;
+    // a node's path goes through the link on which it was reached first
+    int head = 0, tail = 0;
+    dist[target] = 0;
+    queue[tail++] = target;
+    while (head < tail)
+    {
+        int v = queue[head++];
+        for (int l=inLinkStart[v]; l<inLinkStart[v+1]; l++)
+        {
+            int w = linkSrcNode[l];
+            if (dist[w] == -1)
+            {
+                dist[w] = dist[v] + 1;
+                outLink[w] = l;
+                queue[tail++] = w;
+            }
+        }
+    }
+}
+
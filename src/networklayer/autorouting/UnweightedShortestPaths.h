@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_UNWEIGHTEDSHORTESTPATHS_H
+#define __INET_UNWEIGHTEDSHORTESTPATHS_H
+
+#include <vector>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+
+/**
+ * Computes unweighted shortest paths towards the nodes of a cTopology,
+ * one target node at a time, for the network configurators that add a
+ * route to every node from every other node.
+ *
+ * The graph is copied from the cTopology into flat arrays in the ctor, and
+ * nodes are referred to by their cTopology index, so computing the paths
+ * towards all n nodes costs n breadth-first searches over plain arrays.
+ * calculatePathsTo() visits the nodes and links in the same order as
+ * cTopology::calculateUnweightedSingleShortestPathsTo(), so among several
+ * equally short paths it selects the same one.
+ *
+ * The cTopology is not used after the ctor; instances can be copied, and
+ * separate instances can compute paths concurrently.
+ */
+class INET_API UnweightedShortestPaths
+{
+  protected:
+    // in-links of node k are [inLinkStart[k], inLinkStart[k+1]) in the arrays below
+    std::vector<int> inLinkStart;
+    std::vector<int> linkSrcNode;     // node the link starts from
+    std::vector<int> linkSrcGateId;   // output gate of the link in the source node
+    std::vector<int> linkDestNode;    // node the link points to
+    std::vector<int> linkDestGateId;  // input gate of the link in the destination node
+
+    // paths towards target
+    int target;
+    std::vector<int> dist;     // number of hops to target, -1 if not connected
+    std::vector<int> outLink;  // first link on the path, -1 if none
+    std::vector<int> queue;
+
+  public:
+    /**
+     * Copies the graph from topo. Disabled nodes and links are left out.
+     */
+    UnweightedShortestPaths(cTopology& topo);
+
+    /**
+     * Returns the number of nodes, the same as in the cTopology.
+     */
+    int getNumNodes() const {return (int)dist.size();}
+
+    /**
+     * Calculates the shortest paths from every node towards the target node.
+     */
+    void calculatePathsTo(int target);
+
+    /**
+     * Returns the target node of the last calculatePathsTo() call.
+     */
+    int getTarget() const {return target;}
+
+    /**
+     * Returns the number of hops from the node to the target, or -1 if the
+     * target cannot be reached from the node.
+     */
+    int getDistance(int node) const {return dist[node];}
+
+    /**
+     * Returns true if there is a path from the node to the target (the
+     * target itself does not have a path).
+     */
+    bool hasPath(int node) const {return outLink[node] != -1;}
+
+    /**
+     * Returns the next node on the path from the node towards the target,
+     * or -1 if there is no path.
+     */
+    int getNextNode(int node) const {int l = outLink[node]; return l==-1 ? -1 : linkDestNode[l];}
+
+    /**
+     * Returns the id of the output gate of the node where the path to the
+     * target leaves it, or -1 if there is no path.
+     */
+    int getOutputGateId(int node) const {int l = outLink[node]; return l==-1 ? -1 : linkSrcGateId[l];}
+
+    /**
+     * Returns the id of the input gate of the next node where the path to
+     * the target enters it, or -1 if there is no path.
+     */
+    int getNextNodeInputGateId(int node) const {int l = outLink[node]; return l==-1 ? -1 : linkDestGateId[l];}
+};
+
+#endif
+
@@ -148,6 +148,8 @@ void InterfaceTable::addInterface(InterfaceEntry *entry, cModule *ifmod)
     entry->setInterfaceId(INTERFACEIDS_START + idToInterface.size());
     entry->setInterfaceTable(this);
     idToInterface.push_back(entry);
+    indexedKeys.push_back(IndexedKeys());
+    indexInterface(entry);
     invalidateTmpInterfaceList();
 
     // fill in networkLayerGateIndex, nodeOutputGateId, nodeInputGateId
@@ -202,6 +204,7 @@ void InterfaceTable::deleteInterface(InterfaceEntry *entry)
 
     nb->fireChangeNotification(NF_INTERFACE_DELETED, entry);  // actually, only going to be deleted
 
+    unindexInterface(entry);
     idToInterface[id - INTERFACEIDS_START] = NULL;
     delete entry;
     invalidateTmpInterfaceList();
@@ -216,40 +219,135 @@ void InterfaceTable::invalidateTmpInterfaceList()
 
 void InterfaceTable::interfaceChanged(InterfaceEntry *entry, int category)
 {
+    // gate ids/index and name may have changed: update the lookup indices
+    if (category==NF_INTERFACE_CONFIG_CHANGED && entry==getInterfaceById(entry->getInterfaceId()))
+    {
+        const IndexedKeys& keys = indexedKeys[entry->getInterfaceId() - INTERFACEIDS_START];
+        if (keys.nodeOutputGateId!=entry->getNodeOutputGateId() || keys.nodeInputGateId!=entry->getNodeInputGateId() ||
+            keys.networkLayerGateIndex!=entry->getNetworkLayerGateIndex() || keys.name!=entry->getName())
+        {
+            unindexInterface(entry);
+            indexInterface(entry);
+        }
+    }
+
     nb->fireChangeNotification(category, entry);
 }
 
-InterfaceEntry *InterfaceTable::getInterfaceByNodeOutputGateId(int id)
+enum {BY_OUTPUTGATEID, BY_INPUTGATEID, BY_GATEINDEX, BY_NAME};
+
+InterfaceEntry *InterfaceTable::findFirstWithKeys(const IndexedKeys& keys, int what)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
-    Enter_Method_Silent();
+    // linear search among the indexed keys; only used when the indexed
+    // interface gets removed from an index and another one may have the same key
     int n = idToInterface.size();
     for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNodeOutputGateId()==id)
+    {
+        if (!idToInterface[i])
+            continue;
+        const IndexedKeys& k = indexedKeys[i];
+        if ((what==BY_OUTPUTGATEID && k.nodeOutputGateId==keys.nodeOutputGateId) ||
+            (what==BY_INPUTGATEID && k.nodeInputGateId==keys.nodeInputGateId) ||
+            (what==BY_GATEINDEX && k.networkLayerGateIndex==keys.networkLayerGateIndex) ||
+            (what==BY_NAME && k.name==keys.name))
             return idToInterface[i];
+    }
     return NULL;
 }
 
+void InterfaceTable::indexInterface(InterfaceEntry *entry)
+{
+    int pos = entry->getInterfaceId() - INTERFACEIDS_START;
+    IndexedKeys& keys = indexedKeys[pos];
+    keys.nodeOutputGateId = entry->getNodeOutputGateId();
+    keys.nodeInputGateId = entry->getNodeInputGateId();
+    keys.networkLayerGateIndex = entry->getNetworkLayerGateIndex();
+    keys.name = entry->getName();
+
+    // an existing entry with a lower id takes precedence
+    if (keys.nodeOutputGateId!=-1)
+    {
+        InterfaceEntry *&e = nodeOutputGateIdToInterface[keys.nodeOutputGateId];
+        if (!e || e->getInterfaceId() > entry->getInterfaceId())
+            e = entry;
+    }
+    if (keys.nodeInputGateId!=-1)
+    {
+        InterfaceEntry *&e = nodeInputGateIdToInterface[keys.nodeInputGateId];
+        if (!e || e->getInterfaceId() > entry->getInterfaceId())
+            e = entry;
+    }
+    if (keys.networkLayerGateIndex>=0)
+    {
+        if (keys.networkLayerGateIndex >= (int)networkLayerGateIndexToInterface.size())
+            networkLayerGateIndexToInterface.resize(keys.networkLayerGateIndex+1, NULL);
+        InterfaceEntry *&e = networkLayerGateIndexToInterface[keys.networkLayerGateIndex];
+        if (!e || e->getInterfaceId() > entry->getInterfaceId())
+            e = entry;
+    }
+    InterfaceEntry *&e = nameToInterface[keys.name];
+    if (!e || e->getInterfaceId() > entry->getInterfaceId())
+        e = entry;
+}
+
+void InterfaceTable::unindexInterface(InterfaceEntry *entry)
+{
+    int pos = entry->getInterfaceId() - INTERFACEIDS_START;
+    IndexedKeys keys = indexedKeys[pos];
+
+    // make sure findFirstWithKeys() won't find entry itself
+    indexedKeys[pos].nodeOutputGateId = indexedKeys[pos].nodeInputGateId = indexedKeys[pos].networkLayerGateIndex = -1;
+    indexedKeys[pos].name.clear();
+
+    GateIdToInterfaceMap::iterator it = nodeOutputGateIdToInterface.find(keys.nodeOutputGateId);
+    if (it!=nodeOutputGateIdToInterface.end() && it->second==entry)
+    {
+        InterfaceEntry *other = findFirstWithKeys(keys, BY_OUTPUTGATEID);
+        if (other)
+            it->second = other;
+        else
+            nodeOutputGateIdToInterface.erase(it);
+    }
+    it = nodeInputGateIdToInterface.find(keys.nodeInputGateId);
+    if (it!=nodeInputGateIdToInterface.end() && it->second==entry)
+    {
+        InterfaceEntry *other = findFirstWithKeys(keys, BY_INPUTGATEID);
+        if (other)
+            it->second = other;
+        else
+            nodeInputGateIdToInterface.erase(it);
+    }
+    if (keys.networkLayerGateIndex>=0 && networkLayerGateIndexToInterface[keys.networkLayerGateIndex]==entry)
+        networkLayerGateIndexToInterface[keys.networkLayerGateIndex] = findFirstWithKeys(keys, BY_GATEINDEX);
+    NameToInterfaceMap::iterator it2 = nameToInterface.find(keys.name);
+    if (it2!=nameToInterface.end() && it2->second==entry)
+    {
+        InterfaceEntry *other = findFirstWithKeys(keys, BY_NAME);
+        if (other)
+            it2->second = other;
+        else
+            nameToInterface.erase(it2);
+    }
+}
+
+InterfaceEntry *InterfaceTable::getInterfaceByNodeOutputGateId(int id)
+{
+    Enter_Method_Silent();
+    GateIdToInterfaceMap::iterator it = nodeOutputGateIdToInterface.find(id);
+    return it==nodeOutputGateIdToInterface.end() ? NULL : it->second;
+}
+
 InterfaceEntry *InterfaceTable::getInterfaceByNodeInputGateId(int id)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
     Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNodeInputGateId()==id)
-            return idToInterface[i];
-    return NULL;
+    GateIdToInterfaceMap::iterator it = nodeInputGateIdToInterface.find(id);
+    return it==nodeInputGateIdToInterface.end() ? NULL : it->second;
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByNetworkLayerGateIndex(int index)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
     Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNetworkLayerGateIndex()==index)
-            return idToInterface[i];
-    return NULL;
+    return (index<0 || index>=(int)networkLayerGateIndexToInterface.size()) ? NULL : networkLayerGateIndexToInterface[index];
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByName(const char *name)
@@ -257,11 +355,8 @@ InterfaceEntry *InterfaceTable::getInterfaceByName(const char *name)
     Enter_Method_Silent();
     if (!name)
         return NULL;
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && !strcmp(name, idToInterface[i]->getName()))
-            return idToInterface[i];
-    return NULL;
+    NameToInterfaceMap::iterator it = nameToInterface.find(name);
+    return it==nameToInterface.end() ? NULL : it->second;
 }
 
 InterfaceEntry *InterfaceTable::getFirstLoopbackInterface()
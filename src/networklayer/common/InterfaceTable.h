@@ -19,8 +19,10 @@
 #define __INET_INTERFACETABLE_H
 
 #include <vector>
+#include <string>
 #include <omnetpp.h>
 #include "INETDefs.h"
+#include "INETHash.h"
 #include "IInterfaceTable.h"
 #include "InterfaceEntry.h"
 #include "NotificationBoard.h"
@@ -77,6 +79,27 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
     int tmpNumInterfaces; // caches number of non-NULL elements of idToInterface; -1 if invalid
     InterfaceEntry **tmpInterfaceList; // caches non-NULL elements of idToInterface; NULL if invalid
 
+    // Indices for the getInterfaceByXXX() lookup functions. They are updated
+    // in addInterface(), deleteInterface() and whenever the configuration of
+    // an interface changes. Gate ids are sparse, so they are hashed; network
+    // layer gate indices are small, so that table is direct-indexed. When
+    // several interfaces have the same key, the one with the lowest id is
+    // indexed, just as the linear search used to find.
+    struct IndexedKeys
+    {
+        int nodeOutputGateId;
+        int nodeInputGateId;
+        int networkLayerGateIndex;
+        std::string name;
+    };
+    typedef inet_hash::unordered_map<int,InterfaceEntry *> GateIdToInterfaceMap;
+    typedef inet_hash::unordered_map<std::string,InterfaceEntry *> NameToInterfaceMap;
+    std::vector<IndexedKeys> indexedKeys; // parallel to idToInterface: the keys the interface is indexed with
+    GateIdToInterfaceMap nodeOutputGateIdToInterface;
+    GateIdToInterfaceMap nodeInputGateIdToInterface;
+    InterfaceVector networkLayerGateIndexToInterface; // may contain NULLs
+    NameToInterfaceMap nameToInterface;
+
   protected:
     // displays summary above the icon
     virtual void updateDisplayString();
@@ -90,6 +113,11 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
     // internal
     virtual void invalidateTmpInterfaceList();
 
+    // maintaining the lookup indices
+    virtual void indexInterface(InterfaceEntry *entry);
+    virtual void unindexInterface(InterfaceEntry *entry);
+    virtual InterfaceEntry *findFirstWithKeys(const IndexedKeys& keys, int what);
+
   public:
     InterfaceTable();
     virtual ~InterfaceTable();
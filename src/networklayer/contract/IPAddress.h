@@ -250,6 +250,17 @@ class INET_API IPAddress
     static bool isWellFormed(const char *text);
 };
 
+/**
+ * Hash function for IPAddress, for use with hash tables (see INETHash.h).
+ */
+struct IPAddressHash
+{
+    size_t operator()(const IPAddress& addr) const {
+        size_t h = addr.getInt();
+        return h ^ (h >> 16);
+    }
+};
+
 inline std::ostream& operator<<(std::ostream& os, const IPAddress& ip)
 {
     return os << ip.str();
@@ -291,6 +291,21 @@ class INET_API IPv6AddressPrefix : public IPv6Address
 };
 */
 
+/**
+ * Hash function for IPv6Address, for use with hash tables (see INETHash.h).
+ */
+struct IPv6AddressHash
+{
+    size_t operator()(const IPv6Address& addr) const {
+        const uint32 *d = addr.words();
+        size_t h = d[0];
+        h = h * 31 + d[1];
+        h = h * 31 + d[2];
+        h = h * 31 + d[3];
+        return h ^ (h >> 16);
+    }
+};
+
 inline std::ostream& operator<<(std::ostream& os, const IPv6Address& ip)
 {
     return os << ip.str();
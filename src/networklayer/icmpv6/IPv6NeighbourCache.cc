@@ -42,6 +42,15 @@ IPv6NeighbourCache::IPv6NeighbourCache()
     WATCH_MAP(neighbourMap);
 }
 
+IPv6NeighbourCache::~IPv6NeighbourCache()
+{
+    for (NeighbourMap::iterator it=neighbourMap.begin(); it!=neighbourMap.end(); ++it)
+    {
+        delete it->second.nudTimeoutEvent;
+        delete it->second.arTimer;
+    }
+}
+
 IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::lookup(const IPv6Address& addr, int interfaceID)
 {
     Key key(addr, interfaceID);
@@ -55,38 +64,41 @@ const IPv6NeighbourCache::Key *IPv6NeighbourCache::lookupKeyAddr(Key& key)
     return &(i->first);
 }
 
-IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addNeighbour(const IPv6Address& addr, int interfaceID)
+IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::createEntry(const IPv6Address& addr, int interfaceID)
 {
     Key key(addr, interfaceID);
-    ASSERT(neighbourMap.find(key)==neighbourMap.end()); // entry must not exist yet
-    Neighbour& nbor = neighbourMap[key];
+    std::pair<NeighbourMap::iterator,bool> res = neighbourMap.insert(NeighbourMap::value_type(key, Neighbour()));
+    ASSERT(res.second); // entry must not exist yet
+    Neighbour& nbor = res.first->second;
+
+    nbor.nceKey = &res.first->first;//a ptr that links to the key.-WEI for convenience.
+    nbor.nudTimeoutEvent = NULL;
+    nbor.numOfARNSSent = 0;
+    nbor.arTimer = NULL;
+    return &nbor;
+}
 
-    nbor.nceKey = lookupKeyAddr(key);//a ptr that links to the key.-WEI for convenience.
+IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addNeighbour(const IPv6Address& addr, int interfaceID)
+{
+    Neighbour& nbor = *createEntry(addr, interfaceID);
     nbor.isRouter = false;
     nbor.isDefaultRouter = false;
     nbor.reachabilityState = INCOMPLETE;
     nbor.reachabilityExpires = 0;
     nbor.numProbesSent = 0;
-    nbor.nudTimeoutEvent = NULL;
-    nbor.numOfARNSSent = 0;
     nbor.routerExpiryTime = 0;
     return &nbor;
 }
 
 IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addNeighbour(const IPv6Address& addr, int interfaceID, MACAddress macAddress)
 {
-    Key key(addr, interfaceID);
-    ASSERT(neighbourMap.find(key)==neighbourMap.end()); // entry must not exist yet
-    Neighbour& nbor = neighbourMap[key];
-
-    nbor.nceKey = lookupKeyAddr(key);//a ptr that links to the key.-WEI for convenience.
+    Neighbour& nbor = *createEntry(addr, interfaceID);
     nbor.macAddress = macAddress;
     nbor.isRouter = false;
     nbor.isDefaultRouter = false;
     nbor.reachabilityState = STALE;
     nbor.reachabilityExpires = 0;
     nbor.numProbesSent = 0;
-    nbor.nudTimeoutEvent = NULL;
     nbor.routerExpiryTime = 0;
     return &nbor;
 }
@@ -94,38 +106,29 @@ IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addNeighbour(const IPv6Addres
 /** Creates and initializes a router entry (isRouter=isDefaultRouter=true), state=INCOMPLETE. */
 IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addRouter(const IPv6Address& addr, int interfaceID, simtime_t expiryTime)
 {
-    Key key(addr, interfaceID);
-    ASSERT(neighbourMap.find(key)==neighbourMap.end()); // entry must not exist yet
-    Neighbour& nbor = neighbourMap[key];
-
-    nbor.nceKey = lookupKeyAddr(key);//a ptr that links to the key.-WEI for convenience.
+    Neighbour& nbor = *createEntry(addr, interfaceID);
     nbor.isRouter = true;
     nbor.isDefaultRouter = true;//FIXME: a router may advertise itself it self as a router but not as a default one.-WEI
     nbor.reachabilityState = INCOMPLETE;
     nbor.reachabilityExpires = 0;
     nbor.numProbesSent = 0;
-    nbor.nudTimeoutEvent = NULL;
     nbor.routerExpiryTime = expiryTime;
+    routerMap[*nbor.nceKey] = &nbor;
     return &nbor;
 }
 
 /** Creates and initializes a router entry (isRouter=isDefaultRouter=true), MAC address and state=STALE. */
 IPv6NeighbourCache::Neighbour *IPv6NeighbourCache::addRouter(const IPv6Address& addr, int interfaceID, MACAddress macAddress, simtime_t expiryTime)
 {
-    Key key(addr, interfaceID);
-    ASSERT(neighbourMap.find(key)==neighbourMap.end()); // entry must not exist yet
-    Neighbour& nbor = neighbourMap[key];
-
-    nbor.nceKey = lookupKeyAddr(key);//a ptr that links to the key.-WEI for convenience.
+    Neighbour& nbor = *createEntry(addr, interfaceID);
     nbor.macAddress = macAddress;
     nbor.isRouter = true;
     nbor.isDefaultRouter = true;
     nbor.reachabilityState = STALE;
     nbor.reachabilityExpires = 0;
     nbor.numProbesSent = 0;
-    nbor.nudTimeoutEvent = NULL;
-
     nbor.routerExpiryTime = expiryTime;
+    routerMap[*nbor.nceKey] = &nbor;
     return &nbor;
 }
 
@@ -134,13 +137,14 @@ void IPv6NeighbourCache::remove(const IPv6Address& addr, int interfaceID)
     Key key(addr, interfaceID);
     NeighbourMap::iterator it = neighbourMap.find(key);
     ASSERT(it!=neighbourMap.end()); // entry must exist
-    delete it->second.nudTimeoutEvent;
-    neighbourMap.erase(it);
+    remove(it);
 }
 
 void IPv6NeighbourCache::remove(NeighbourMap::iterator it)
 {
+    routerMap.erase(it->first);
     delete it->second.nudTimeoutEvent;
+    delete it->second.arTimer;
     neighbourMap.erase(it);
 }
 
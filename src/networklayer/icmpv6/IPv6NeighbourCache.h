@@ -24,6 +24,7 @@
 #include <omnetpp.h>
 #include "IPv6Address.h"
 #include "MACAddress.h"
+#include "TimerWheel.h"
 
 
 /**
@@ -37,7 +38,12 @@
  * NOTE: we don't keep a separate Default Router List, the Neighbour
  * Cache serves that purpose too. Removing an entry from the
  * Default Router List in our case is done by setting the isDefaultRouter
- * flag of the entry to false.
+ * flag of the entry to false. The cache maintains an index of the entries
+ * added with addRouter() though, so that default router selection does not
+ * need to go through all neighbours.
+ *
+ * The NUD and address resolution timers of the entries are owned by the
+ * cache, and get deleted together with the entry.
  */
 class INET_API IPv6NeighbourCache
 {
@@ -75,14 +81,14 @@ class INET_API IPv6NeighbourCache
         ReachabilityState reachabilityState;
         simtime_t reachabilityExpires; // reachabilityLastConfirmed+reachableTime
         short numProbesSent;
-        cMessage *nudTimeoutEvent; // DELAY or PROBE timer
+        WheelTimer *nudTimeoutEvent; // DELAY or PROBE timer
 
         //WEI-We could have a seperate AREntry in the ND module.
         //But we should merge those information in the neighbour cache for a
         //cleaner solution. if reachability state is INCOMPLETE, it means that
         //addr resolution is being performed for this NCE.
         int numOfARNSSent;
-        cMessage *arTimer;//Address Resolution self-message timer
+        WheelTimer *arTimer;//Address Resolution self-message timer
         MsgPtrVector pendingPackets; //ptrs to queued packets associated with this NCE
         IPv6Address nsSrcAddr;//the src addr that was used to send the previous NS
 
@@ -107,12 +113,19 @@ class INET_API IPv6NeighbourCache
     typedef std::map<Key,Neighbour> NeighbourMap;
     typedef NeighbourMap::iterator iterator;
 
+    /** Entries added with addRouter(), in the same order as in the Neighbour Cache */
+    typedef std::map<Key,Neighbour*> RouterMap;
+
   protected:
     NeighbourMap neighbourMap;
+    RouterMap routerMap;
+
+  protected:
+    Neighbour *createEntry(const IPv6Address& addr, int interfaceID);
 
   public:
     IPv6NeighbourCache();
-    virtual ~IPv6NeighbourCache() {}
+    virtual ~IPv6NeighbourCache();
 
     /** Returns a neighbour entry, or NULL. */
     virtual Neighbour *lookup(const IPv6Address& addr, int interfaceID);
@@ -126,6 +139,9 @@ class INET_API IPv6NeighbourCache
     /** For iteration on the internal std::map */
     iterator end()  {return neighbourMap.end();}
 
+    /** Returns the router entries (the ones added with addRouter()) */
+    const RouterMap& getRouters() const  {return routerMap;}
+
     /** Creates and initializes a neighbour entry with isRouter=false, state=INCOMPLETE. */
     //TODO merge into next one (using default arg)
     virtual Neighbour *addNeighbour(const IPv6Address& addr, int interfaceID);
@@ -37,13 +37,13 @@ IPv6NeighbourDiscovery::IPv6NeighbourDiscovery()
 
 IPv6NeighbourDiscovery::~IPv6NeighbourDiscovery()
 {
-    // FIXME delete the following data structures, cancelAndDelete timers in them etc.
-    // Deleting the data structures my become unnecessary if the lists store the
-    // structs themselves and not pointers.
-    //   RATimerList raTimerList;
-    //   DADList dadList;
-    //   RDList rdList;
-    //   AdvIfList advIfList;
+    // wheel timers need not be cancelled, they remove themselves from the wheel
+    for (DADList::iterator it=dadList.begin(); it!=dadList.end(); ++it)
+        delete it->second.timeoutMsg;
+    for (RDList::iterator it=rdList.begin(); it!=rdList.end(); ++it)
+        delete it->second.timeoutMsg;
+    for (AdvIfList::iterator it=advIfList.begin(); it!=advIfList.end(); ++it)
+        cancelAndDelete(it->second.raTimeoutMsg);
 }
 
 void IPv6NeighbourDiscovery::initialize(int stage)
@@ -57,6 +57,7 @@ void IPv6NeighbourDiscovery::initialize(int stage)
         rt6 = RoutingTable6Access().get();
         icmpv6 = ICMPv6Access().get();
         pendingQueue.setName("pendingQueue");
+        timerWheel.init(this, par("timerGranularity"), "ndTimerTick");
 
         for (int i=0; i < ift->getNumInterfaces(); i++)
         {
@@ -80,51 +81,16 @@ void IPv6NeighbourDiscovery::initialize(int stage)
 
 void IPv6NeighbourDiscovery::handleMessage(cMessage *msg)
 {
-    if (msg->isSelfMessage())
+    if (timerWheel.isTickMessage(msg))
     {
-        EV << "Self message received!\n";
-        if (msg->getKind()==MK_SEND_PERIODIC_RTRADV)
-        {
-            EV << "Sending periodic RA\n";
-            sendPeriodicRA(msg);
-        }
-        else if (msg->getKind()==MK_SEND_SOL_RTRADV)
-        {
-            EV << "Sending solicited RA\n";
-            sendSolicitedRA(msg);
-        }
-        else if (msg->getKind()==MK_ASSIGN_LINKLOCAL_ADDRESS)
-        {
-            EV << "Assigning Link Local Address\n";
-            assignLinkLocalAddress(msg);
-        }
-        else if (msg->getKind()==MK_DAD_TIMEOUT)
-        {
-            EV << "DAD Timeout message received\n";
-            processDADTimeout(msg);
-        }
-        else if (msg->getKind()==MK_RD_TIMEOUT)
-        {
-            EV << "Router Discovery message received\n";
-            processRDTimeout(msg);
-        }
-        else if (msg->getKind()==MK_INITIATE_RTRDIS)
-        {
-            EV << "initiate router discovery.\n";
-            initiateRouterDiscovery(msg);
-        }
-        else if (msg->getKind()==MK_NUD_TIMEOUT)
-        {
-            EV << "NUD Timeout message received\n";
-            processNUDTimeout(msg);
-        }
-        else if (msg->getKind()==MK_AR_TIMEOUT)
-        {
-            EV << "Address Resolution Timeout message received\n";
-            processARTimeout(msg);
-        }
-        else
-            error("Unrecognized Timer");//stops sim w/ error msg.
+        WheelTimer *timer;
+        while ((timer = timerWheel.popExpired()) != NULL)
+            processTimer(timer);
+        timerWheel.rearm();
+    }
+    else if (msg->isSelfMessage())
+    {
+        processTimer(msg);
     }
     else if (dynamic_cast<ICMPv6Message *>(msg))
     {
@@ -143,6 +109,53 @@ void IPv6NeighbourDiscovery::handleMessage(cMessage *msg)
         error("Unknown message type received.\n");
 }
 
+void IPv6NeighbourDiscovery::processTimer(cMessage *msg)
+{
+    EV << "Self message received!\n";
+    if (msg->getKind()==MK_SEND_PERIODIC_RTRADV)
+    {
+        EV << "Sending periodic RA\n";
+        sendPeriodicRA(msg);
+    }
+    else if (msg->getKind()==MK_SEND_SOL_RTRADV)
+    {
+        EV << "Sending solicited RA\n";
+        sendSolicitedRA(msg);
+    }
+    else if (msg->getKind()==MK_ASSIGN_LINKLOCAL_ADDRESS)
+    {
+        EV << "Assigning Link Local Address\n";
+        assignLinkLocalAddress(msg);
+    }
+    else if (msg->getKind()==MK_DAD_TIMEOUT)
+    {
+        EV << "DAD Timeout message received\n";
+        processDADTimeout(check_and_cast<WheelTimer *>(msg));
+    }
+    else if (msg->getKind()==MK_RD_TIMEOUT)
+    {
+        EV << "Router Discovery message received\n";
+        processRDTimeout(check_and_cast<WheelTimer *>(msg));
+    }
+    else if (msg->getKind()==MK_INITIATE_RTRDIS)
+    {
+        EV << "initiate router discovery.\n";
+        initiateRouterDiscovery(msg);
+    }
+    else if (msg->getKind()==MK_NUD_TIMEOUT)
+    {
+        EV << "NUD Timeout message received\n";
+        processNUDTimeout(check_and_cast<WheelTimer *>(msg));
+    }
+    else if (msg->getKind()==MK_AR_TIMEOUT)
+    {
+        EV << "Address Resolution Timeout message received\n";
+        processARTimeout(check_and_cast<WheelTimer *>(msg));
+    }
+    else
+        error("Unrecognized Timer");//stops sim w/ error msg.
+}
+
 void IPv6NeighbourDiscovery::processNDMessage(ICMPv6Message *msg,
     IPv6ControlInfo *ctrlInfo)
 {
@@ -259,28 +272,14 @@ void IPv6NeighbourDiscovery::processIPv6Datagram(IPv6Datagram *msg)
 
 IPv6NeighbourDiscovery::AdvIfEntry *IPv6NeighbourDiscovery::fetchAdvIfEntry(InterfaceEntry *ie)
 {
-   for (AdvIfList::iterator it=advIfList.begin(); it!=advIfList.end(); it++)
-   {
-       AdvIfEntry *advIfEntry = (*it);
-       if (advIfEntry->interfaceId == ie->getInterfaceId())
-       {
-           return advIfEntry;
-       }
-   }
-   return NULL;
+    AdvIfList::iterator it = advIfList.find(ie->getInterfaceId());
+    return it==advIfList.end() ? NULL : &it->second;
 }
 
 IPv6NeighbourDiscovery::RDEntry *IPv6NeighbourDiscovery::fetchRDEntry(InterfaceEntry *ie)
 {
-   for (RDList::iterator it=rdList.begin(); it!=rdList.end(); it++)
-   {
-       RDEntry *rdEntry = (*it);
-       if (rdEntry->interfaceId == ie->getInterfaceId())
-       {
-           return rdEntry;
-       }
-   }
-   return NULL;
+    RDList::iterator it = rdList.find(ie->getInterfaceId());
+    return it==rdList.end() ? NULL : &it->second;
 }
 
 const MACAddress& IPv6NeighbourDiscovery::resolveNeighbour(const IPv6Address& nextHop, int interfaceId)
@@ -318,14 +317,15 @@ void IPv6NeighbourDiscovery::reachabilityConfirmed(const IPv6Address& neighbour,
     //currently being performed on the neighbour where the TCP ACK was received from.
 
     Neighbour *nce = neighbourCache.lookup(neighbour, interfaceId);
+    if (!nce)
+        return;
 
-    cMessage *msg = nce->nudTimeoutEvent;
-    if (msg != NULL)
+    WheelTimer *msg = nce->nudTimeoutEvent;
+    if (msg != NULL && msg->isPending())
     {
         EV << "NUD in progress. Cancelling NUD Timer\n";
         bubble("Reachability Confirmed via NUD.");
-        cancelEvent(msg);
-        delete msg;
+        timerWheel.cancel(msg);
     }
 
     // TODO (see header file for description)
@@ -440,13 +440,20 @@ void IPv6NeighbourDiscovery::initiateNeighbourUnreachabilityDetection(
     nce->reachabilityState = IPv6NeighbourCache::DELAY;
 
     /*and sets a timer to expire in DELAY_FIRST_PROBE_TIME seconds.*/
-    cMessage *msg = new cMessage("NUDTimeout", MK_NUD_TIMEOUT);
-    msg->setContextPointer(nce);
-    nce->nudTimeoutEvent = msg;
-    scheduleAt(simTime()+ie->ipv6Data()->_getDelayFirstProbeTime(), msg);
+    WheelTimer *msg = nce->nudTimeoutEvent;
+    if (msg == NULL)
+    {
+        // the timer is owned by the NCE, and reused during its lifetime
+        msg = new WheelTimer("NUDTimeout", MK_NUD_TIMEOUT);
+        msg->setContextPointer(nce);
+        nce->nudTimeoutEvent = msg;
+    }
+    else
+        timerWheel.cancel(msg);
+    timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getDelayFirstProbeTime(), msg);
 }
 
-void IPv6NeighbourDiscovery::processNUDTimeout(cMessage *timeoutMsg)
+void IPv6NeighbourDiscovery::processNUDTimeout(WheelTimer *timeoutMsg)
 {
     EV << "NUD has timed out\n";
     Neighbour *nce = (Neighbour *) timeoutMsg->getContextPointer();
@@ -485,7 +492,7 @@ void IPv6NeighbourDiscovery::processNUDTimeout(cMessage *timeoutMsg)
     every RetransTimer milliseconds until reachability confirmation is obtained.
     Probes are retransmitted even if no additional packets are sent to the
     neighbor.*/
-    scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), timeoutMsg);
+    timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), timeoutMsg);
 }
 
 IPv6Address IPv6NeighbourDiscovery::selectDefaultRouter(int& outIfID)
@@ -506,35 +513,41 @@ IPv6Address IPv6NeighbourDiscovery::selectDefaultRouter(int& outIfID)
     The policy for selecting routers from the Default Router List is as
     follows:*/
 
+    //Cycle through the default router list (the router entries of the neighbour
+    //cache). Expired routers are only removed after the loop, as removing them
+    //would invalidate the iterator.
+    const IPv6NeighbourCache::RouterMap& routers = neighbourCache.getRouters();
+    std::vector<Key> expiredRouters;
+    bool found = false;
     IPv6Address routerAddr;
-    //Cycle through all entries in the neighbour cache entry.
-    for(IPv6NeighbourCache::iterator it=neighbourCache.begin(); it != neighbourCache.end(); it++)
+    for (IPv6NeighbourCache::RouterMap::const_iterator it=routers.begin(); it != routers.end(); it++)
     {
-        Key key = it->first;
-        Neighbour nce = it->second;
-        bool routerExpired = false;
-        if (nce.isDefaultRouter)
+        const Key& key = it->first;
+        const Neighbour *nce = it->second;
+        if (!nce->isDefaultRouter)
+            continue;
+        if (simTime()>nce->routerExpiryTime)
         {
-            if (simTime()>nce.routerExpiryTime)
-            {
-                EV << "Found an expired default router. Deleting entry...\n";
-                neighbourCache.remove(key.address,key.interfaceID);
-                routerExpired = true;
-            }
+            EV << "Found an expired default router. Deleting entry...\n";
+            expiredRouters.push_back(key);
+            continue;
         }
 
-        if (routerExpired == false)
+        if (nce->reachabilityState == IPv6NeighbourCache::REACHABLE ||
+            nce->reachabilityState == IPv6NeighbourCache::STALE ||
+            nce->reachabilityState == IPv6NeighbourCache::DELAY)//TODO: Need to improve this algorithm!
         {
-            if (nce.reachabilityState == IPv6NeighbourCache::REACHABLE ||
-                nce.reachabilityState == IPv6NeighbourCache::STALE ||
-                nce.reachabilityState == IPv6NeighbourCache::DELAY)//TODO: Need to improve this algorithm!
-            {
-                EV << "Found a router in the neighbour cache(default router list).\n";
-                outIfID = key.interfaceID;
-                if (routerExpired == false) return key.address;
-            }
+            EV << "Found a router in the neighbour cache(default router list).\n";
+            outIfID = key.interfaceID;
+            routerAddr = key.address;
+            found = true;
+            break;
         }
     }
+    for (unsigned int i=0; i<expiredRouters.size(); i++)
+        neighbourCache.remove(expiredRouters[i].address, expiredRouters[i].interfaceID);
+    if (found)
+        return routerAddr;
     EV << "No suitable routers found.\n";
 
     /*1) Routers that are reachable or probably reachable (i.e., in any state
@@ -636,14 +649,21 @@ void IPv6NeighbourDiscovery::initiateAddressResolution(const IPv6Address& dgSrcA
     messages approximately every RetransTimer milliseconds, even in the absence
     of additional traffic to the neighbor. Retransmissions MUST be rate-limited
     to at most one solicitation per neighbor every RetransTimer milliseconds.*/
-    cMessage *msg = new cMessage("arTimeout", MK_AR_TIMEOUT);//AR msg timer
-    nce->arTimer = msg;
-    msg->setContextPointer(nce);
-    scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), msg);
+    WheelTimer *msg = nce->arTimer;
+    if (msg == NULL)
+    {
+        // the timer is owned by the NCE, and reused during its lifetime
+        msg = new WheelTimer("arTimeout", MK_AR_TIMEOUT);//AR msg timer
+        msg->setContextPointer(nce);
+        nce->arTimer = msg;
+    }
+    else
+        timerWheel.cancel(msg);
+    timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), msg);
 }
 
 
-void IPv6NeighbourDiscovery::processARTimeout(cMessage *arTimeoutMsg)
+void IPv6NeighbourDiscovery::processARTimeout(WheelTimer *arTimeoutMsg)
 {
     //AR timeouts are cancelled when a valid solicited NA is received.
     Neighbour *nce = (Neighbour *)arTimeoutMsg->getContextPointer();
@@ -658,13 +678,11 @@ void IPv6NeighbourDiscovery::processARTimeout(cMessage *arTimeoutMsg)
         IPv6Address nsDestAddr = nsTargetAddr.formSolicitedNodeMulticastAddress();
         createAndSendNSPacket(nsTargetAddr, nsDestAddr, nce->nsSrcAddr, ie);
         nce->numOfARNSSent++;
-        scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), arTimeoutMsg);
+        timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getRetransTimer(), arTimeoutMsg);
         return;
     }
     EV << "Address Resolution has failed." << endl;
-    dropQueuedPacketsAwaitingAR(nce);
-    EV << "Deleting AR timeout msg\n";
-    delete arTimeoutMsg;
+    dropQueuedPacketsAwaitingAR(nce); // removes the NCE, which deletes arTimeoutMsg
 }
 
 void IPv6NeighbourDiscovery::dropQueuedPacketsAwaitingAR(Neighbour *nce)
@@ -756,11 +774,17 @@ void IPv6NeighbourDiscovery::assignLinkLocalAddress(cMessage *timerMsg)
 void IPv6NeighbourDiscovery::initiateDAD(const IPv6Address& tentativeAddr,
     InterfaceEntry *ie)
 {
-    DADEntry *dadEntry = new DADEntry();
+    DADEntry *dadEntry = &dadList[Key(tentativeAddr, ie->getInterfaceId())];
+    if (dadEntry->timeoutMsg == NULL)
+    {
+        dadEntry->timeoutMsg = new WheelTimer("dadTimeout", MK_DAD_TIMEOUT);
+        dadEntry->timeoutMsg->setContextPointer(dadEntry);
+    }
+    else
+        timerWheel.cancel(dadEntry->timeoutMsg); // restart DAD for the address
     dadEntry->interfaceId = ie->getInterfaceId();
     dadEntry->address = tentativeAddr;
     dadEntry->numNSSent = 0;
-    dadList.insert(dadEntry);
     /*
     RFC2462: Section 5.4.2
     To check an address, a node sends DupAddrDetectTransmits Neighbor
@@ -775,12 +799,10 @@ void IPv6NeighbourDiscovery::initiateDAD(const IPv6Address& tentativeAddr,
         IPv6Address::UNSPECIFIED_ADDRESS, ie);
     dadEntry->numNSSent++;
 
-    cMessage *msg = new cMessage("dadTimeout", MK_DAD_TIMEOUT);
-    msg->setContextPointer(dadEntry);
-    scheduleAt(simTime()+ie->ipv6Data()->getRetransTimer(), msg);
+    timerWheel.scheduleAt(simTime()+ie->ipv6Data()->getRetransTimer(), dadEntry->timeoutMsg);
 }
 
-void IPv6NeighbourDiscovery::processDADTimeout(cMessage *msg)
+void IPv6NeighbourDiscovery::processDADTimeout(WheelTimer *msg)
 {
     DADEntry *dadEntry = (DADEntry *)msg->getContextPointer();
     InterfaceEntry *ie = (InterfaceEntry *)ift->getInterfaceById(dadEntry->interfaceId);
@@ -796,15 +818,14 @@ void IPv6NeighbourDiscovery::processDADTimeout(cMessage *msg)
         createAndSendNSPacket(dadEntry->address, destAddr, IPv6Address::UNSPECIFIED_ADDRESS, ie);
         dadEntry->numNSSent++;
         //Reuse the received msg
-        scheduleAt(simTime()+ie->ipv6Data()->getRetransTimer(), msg);
+        timerWheel.scheduleAt(simTime()+ie->ipv6Data()->getRetransTimer(), msg);
     }
     else
     {
         bubble("Max number of DAD messages for interface sent. Address is unique.");
         ie->ipv6Data()->permanentlyAssign(tentativeAddr);
-        dadList.erase(dadEntry);
         EV << "delete dadEntry and msg\n";
-        delete dadEntry;
+        dadList.erase(Key(tentativeAddr, dadEntry->interfaceId));
         delete msg;
         /*RFC 2461: Section 6.3.7 2nd Paragraph
         Before a host sends an initial solicitation, it SHOULD delay the
@@ -863,17 +884,17 @@ void IPv6NeighbourDiscovery::initiateRouterDiscovery(cMessage *msg)
     to MAX_RTR_SOLICITATIONS Router Solicitation messages each separated by at
     least RTR_SOLICITATION_INTERVAL seconds.(FIXME:Therefore this should be invoked
     at the beginning of the simulation-WEI)*/
-    RDEntry *rdEntry = new RDEntry();
+    cancelRouterDiscovery(ie); // in case it is already in progress on the interface
+    RDEntry *rdEntry = &rdList[ie->getInterfaceId()];
     rdEntry->interfaceId = ie->getInterfaceId();
     rdEntry->numRSSent = 0;
     createAndSendRSPacket(ie);
     rdEntry->numRSSent++;
 
     //Create and schedule a message for retransmission to this module
-    cMessage *rdTimeoutMsg = new cMessage("processRDTimeout", MK_RD_TIMEOUT);
+    WheelTimer *rdTimeoutMsg = new WheelTimer("processRDTimeout", MK_RD_TIMEOUT);
     rdTimeoutMsg->setContextPointer(ie);
     rdEntry->timeoutMsg = rdTimeoutMsg;
-    rdList.insert(rdEntry);
     /*Before a host sends an initial solicitation, it SHOULD delay the
     transmission for a random amount of time between 0 and
     MAX_RTR_SOLICITATION_DELAY.  This serves to alleviate congestion when
@@ -883,7 +904,7 @@ void IPv6NeighbourDiscovery::initiateRouterDiscovery(cMessage *msg)
     of Duplicate Address Detection [ADDRCONF]) there is no need to delay
     again before sending the first Router Solicitation message.*/
     //simtime_t rndInterval = uniform(0, ie->ipv6Data()->_getMaxRtrSolicitationDelay());
-    scheduleAt(simTime()+ie->ipv6Data()->_getRtrSolicitationInterval(), rdTimeoutMsg);
+    timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getRtrSolicitationInterval(), rdTimeoutMsg);
 }
 
 void IPv6NeighbourDiscovery::cancelRouterDiscovery(InterfaceEntry *ie)
@@ -893,15 +914,14 @@ void IPv6NeighbourDiscovery::cancelRouterDiscovery(InterfaceEntry *ie)
     if (rdEntry != NULL)
     {
         EV << "rdEntry is not NULL, RD cancelled!" << endl;
-        cancelEvent(rdEntry->timeoutMsg);
-        rdList.erase(rdEntry);
-        delete rdEntry;
+        delete rdEntry->timeoutMsg; // takes itself out of the timer wheel
+        rdList.erase(ie->getInterfaceId());
     }
     else
         EV << "rdEntry is NULL, not cancelling RD!" << endl;
 }
 
-void IPv6NeighbourDiscovery::processRDTimeout(cMessage *msg)
+void IPv6NeighbourDiscovery::processRDTimeout(WheelTimer *msg)
 {
     InterfaceEntry *ie = (InterfaceEntry *)msg->getContextPointer();
     RDEntry *rdEntry = fetchRDEntry(ie);
@@ -912,9 +932,9 @@ void IPv6NeighbourDiscovery::processRDTimeout(cMessage *msg)
         rdEntry->numRSSent++;
         //Need to find out if this is the last RS we are sending out.
         if (rdEntry->numRSSent == ie->ipv6Data()->_getMaxRtrSolicitations())
-            scheduleAt(simTime()+ie->ipv6Data()->_getMaxRtrSolicitationDelay(), msg);
+            timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getMaxRtrSolicitationDelay(), msg);
         else
-            scheduleAt(simTime()+ie->ipv6Data()->_getRtrSolicitationInterval(), msg);
+            timerWheel.scheduleAt(simTime()+ie->ipv6Data()->_getRtrSolicitationInterval(), msg);
     }
     else
     {
@@ -927,7 +947,7 @@ void IPv6NeighbourDiscovery::processRDTimeout(cMessage *msg)
         appear on the link.*/
         bubble("Max number of RS messages sent");
         EV << "No RA messages were received. Assume no routers are on-link";
-        delete rdEntry;
+        rdList.erase(ie->getInterfaceId());
         delete msg;
     }
 }
@@ -1441,7 +1461,7 @@ void IPv6NeighbourDiscovery::createRATimer(InterfaceEntry *ie)
 {
     cMessage *msg = new cMessage("sendPeriodicRA", MK_SEND_PERIODIC_RTRADV);
     msg->setContextPointer(ie);
-    AdvIfEntry *advIfEntry = new AdvIfEntry();
+    AdvIfEntry *advIfEntry = &advIfList[ie->getInterfaceId()];
     advIfEntry->interfaceId = ie->getInterfaceId();
     advIfEntry->numRASent = 0;
     simtime_t interval = uniform(ie->ipv6Data()->getMinRtrAdvInterval(), ie->ipv6Data()->getMaxRtrAdvInterval());
@@ -1449,7 +1469,6 @@ void IPv6NeighbourDiscovery::createRATimer(InterfaceEntry *ie)
 
     simtime_t nextScheduledTime = simTime() + interval;
     advIfEntry->nextScheduledRATime = nextScheduledTime;
-    advIfList.insert(advIfEntry);
     EV << "Interval: " << interval << endl;
     EV << "Next scheduled time: " << nextScheduledTime << endl;
     //now we schedule the msg for whatever time that was derived
@@ -2015,7 +2034,8 @@ void IPv6NeighbourDiscovery::processNAForIncompleteNCEState(
         //- It sends any packets queued for the neighbour awaiting address
         //  resolution.
         sendQueuedPacketsToIPv6Module(nce);
-        cancelEvent(nce->arTimer);
+        if (nce->arTimer)
+            timerWheel.cancel(nce->arTimer);
     }
 }
 
@@ -2080,14 +2100,13 @@ void IPv6NeighbourDiscovery:: processNAForOtherNCEStates(
             //the state of the entry MUST be set to REACHABLE.
             nce->reachabilityState = IPv6NeighbourCache::REACHABLE;
             //We have to cancel the NUD self timer message if there is one.
-            cMessage *msg = nce->nudTimeoutEvent;
-            if (msg != NULL)
+            WheelTimer *msg = nce->nudTimeoutEvent;
+            if (msg != NULL && msg->isPending())
             {
                 EV << "NUD in progress. Cancelling NUD Timer\n";
                 bubble("Reachability Confirmed via NUD.");
                 nce->reachabilityExpires = simTime() + ie->ipv6Data()->_getReachableTime();
-                cancelEvent(msg);
-                delete msg;
+                timerWheel.cancel(msg);
             }
         }
         else
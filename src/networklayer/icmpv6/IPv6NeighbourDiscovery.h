@@ -23,6 +23,7 @@
 #include <string.h>
 #include <vector>
 #include <set>
+#include <map>
 #include <omnetpp.h>
 #include "IPv6Address.h"
 #include "IPv6Datagram.h"
@@ -37,6 +38,7 @@
 #include "IPv6NeighbourCache.h"
 #include "ICMPv6.h"
 #include "ICMPv6Access.h"
+#include "TimerWheel.h"
 
 /**
  * Implements RFC 2461 Neighbor Discovery for IPv6.
@@ -90,6 +92,12 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
         IInterfaceTable *ift;
         RoutingTable6 *rt6;
         ICMPv6 *icmpv6;
+
+        // NUD, address resolution, DAD and router discovery timers are
+        // scheduled in this wheel, not in the FES. It must be declared before
+        // the neighbour cache, because the cache deletes timers in its destructor.
+        TimerWheel timerWheel;
+
         IPv6NeighbourCache neighbourCache;
         typedef std::set<cMessage*> RATimerList;
 
@@ -99,17 +107,17 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
             int interfaceId;// interface on which DAD is performed
             IPv6Address address;// link-local address subject to DAD
             int numNSSent;// number of DAD solicitations sent since start of sim
-            cMessage *timeoutMsg;// the message to cancel when NA is received
+            WheelTimer *timeoutMsg;// the message to cancel when NA is received
         };
-        typedef std::set<DADEntry*> DADList; //FIXME why ptrs are stored?
+        typedef std::map<Key,DADEntry> DADList; // keyed by address and interface
 
         //stores information about Router Discovery for an interface
         struct RDEntry {
             int interfaceId; //interface on which Router Discovery is performed
             int numRSSent; //number of Router Solicitations sent since start of sim
-            cMessage *timeoutMsg; //the message to cancel when RA is received
+            WheelTimer *timeoutMsg; //the message to cancel when RA is received
         };
-        typedef std::set<RDEntry*> RDList; //FIXME why ptrs are stored?
+        typedef std::map<int,RDEntry> RDList; // keyed by interfaceId
 
         //An entry that stores information for an Advertising Interface
         struct AdvIfEntry {
@@ -118,7 +126,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
             simtime_t nextScheduledRATime;//stores time when next RA will be sent.
             cMessage *raTimeoutMsg;//the message to cancel when resetting RA timer
         };
-        typedef std::set<AdvIfEntry*> AdvIfList; //FIXME why ptrs are stored?
+        typedef std::map<int,AdvIfEntry> AdvIfList; // keyed by interfaceId
 
         //List of periodic RA msgs(used only for router interfaces)
         RATimerList raTimerList;
@@ -134,6 +142,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
         virtual int numInitStages() const {return 4;}
         virtual void initialize(int stage);
         virtual void handleMessage(cMessage *msg);
+        virtual void processTimer(cMessage *msg);
         virtual void processNDMessage(ICMPv6Message *msg, IPv6ControlInfo *ctrlInfo);
         virtual void finish();
 
@@ -153,7 +162,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
          */
         virtual IPv6Address determineNextHop(const IPv6Address& destAddr, int& outIfID);
         virtual void initiateNeighbourUnreachabilityDetection(Neighbour *neighbour);
-        virtual void processNUDTimeout(cMessage *timeoutMsg);
+        virtual void processNUDTimeout(WheelTimer *timeoutMsg);
         virtual IPv6Address selectDefaultRouter(int& outIfID);
         /**
          *  RFC 2461: Section 6.3.5
@@ -187,7 +196,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
          *  Resends a NS packet to the address intended for address resolution.
          *  TODO: Not implemented yet!
          */
-        virtual void processARTimeout(cMessage *arTimeoutMsg);
+        virtual void processARTimeout(WheelTimer *arTimeoutMsg);
         /**
          *  Drops specific queued packets for a specific NCE AR-timeout.
          *  TODO: Not implemented yet!
@@ -217,7 +226,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
          *  than dupAddrDetectTransmits, then permantly assign target link local
          *  address as permanent address for given interface entry.
          */
-        virtual void processDADTimeout(cMessage *msg);
+        virtual void processDADTimeout(WheelTimer *msg);
 
         /************Address Autoconfiguration Stuff***************************/
         /**
@@ -251,7 +260,7 @@ class INET_API IPv6NeighbourDiscovery : public cSimpleModule
          *  the given Interface Entry.
          */
         virtual void cancelRouterDiscovery(InterfaceEntry *ie);
-        virtual void processRDTimeout(cMessage *msg);
+        virtual void processRDTimeout(WheelTimer *msg);
         virtual void processRSPacket(IPv6RouterSolicitation *rs, IPv6ControlInfo *rsCtrlInfo);
         virtual bool validateRSPacket(IPv6RouterSolicitation *rs, IPv6ControlInfo *rsCtrlInfo);
         /************End of Router Solicitation Stuff**************************/
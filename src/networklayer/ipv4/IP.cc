@@ -328,7 +328,7 @@ void IP::routeMulticastPacket(IPDatagram *datagram, InterfaceEntry *destIE, Inte
     }
 
     // now: routing
-    MulticastRoutes routes = rt->getMulticastRoutesFor(destAddr);
+    const MulticastRoutes& routes = rt->getMulticastRoutesFor(destAddr);
     if (routes.size()==0)
     {
         // no destination: delete datagram
@@ -117,9 +117,11 @@ class INET_API IRoutingTable
     virtual bool isLocalMulticastAddress(const IPAddress& dest) const = 0;
 
     /**
-     * Returns routes for a multicast address.
+     * Returns routes for a multicast address. The returned list is owned
+     * by the routing table, and it is only valid until the routing table
+     * or the interfaces change.
      */
-    virtual MulticastRoutes getMulticastRoutesFor(const IPAddress& dest) const = 0;
+    virtual const MulticastRoutes& getMulticastRoutesFor(const IPAddress& dest) const = 0;
     //@}
 
     /** @name Route table manipulation */
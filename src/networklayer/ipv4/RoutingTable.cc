@@ -46,6 +46,8 @@ std::ostream& operator<<(std::ostream& os, const IPRoute& e)
 
 RoutingTable::RoutingTable()
 {
+    numWildcardMulticastRoutes = 0;
+    maxMulticastCacheSize = 0;
 }
 
 RoutingTable::~RoutingTable()
@@ -65,6 +67,9 @@ void RoutingTable::initialize(int stage)
         ift = InterfaceTableAccess().get();
 
         IPForward = par("IPForward").boolValue();
+        maxMulticastCacheSize = par("maxMulticastCacheSize");
+        if (maxMulticastCacheSize<0)
+            error("maxMulticastCacheSize must not be negative");
 
         nb->subscribe(this, NF_INTERFACE_CREATED);
         nb->subscribe(this, NF_INTERFACE_DELETED);
@@ -214,12 +219,44 @@ void RoutingTable::deleteInterfaceRoutes(InterfaceEntry *entry)
             ++it;
         }
     }
+
+    // multicast routes too, otherwise the multicast routing cache would
+    // keep pointing to the deleted interface
+    for (unsigned int k=0; k<multicastRoutes.size(); k++)
+        if (multicastRoutes[k]->getInterface() == entry)
+            deleteRoute(multicastRoutes[k--]);  // '--' is necessary because indices shift down
 }
 
 void RoutingTable::invalidateCache()
 {
     routingCache.clear();
     localAddresses.clear();
+    multicastRoutingCache.clear();
+}
+
+void RoutingTable::indexMulticastRoute(IPRoute *entry)
+{
+    if (entry->getNetmask()==IPAddress::ALLONES_ADDRESS)
+        multicastGroupRoutes[entry->getHost()].push_back(entry);
+    else
+        numWildcardMulticastRoutes++;
+}
+
+void RoutingTable::unindexMulticastRoute(IPRoute *entry)
+{
+    if (entry->getNetmask()==IPAddress::ALLONES_ADDRESS)
+    {
+        MulticastGroupIndex::iterator it = multicastGroupRoutes.find(entry->getHost());
+        ASSERT(it!=multicastGroupRoutes.end());
+        RouteVector& groupRoutes = it->second;
+        groupRoutes.erase(std::find(groupRoutes.begin(), groupRoutes.end(), entry));
+        if (groupRoutes.empty())
+            multicastGroupRoutes.erase(it);
+    }
+    else
+    {
+        numWildcardMulticastRoutes--;
+    }
 }
 
 void RoutingTable::printRoutingTable() const
@@ -359,13 +396,31 @@ IPAddress RoutingTable::getGatewayForDestAddr(const IPAddress& dest) const
 }
 
 
-MulticastRoutes RoutingTable::getMulticastRoutesFor(const IPAddress& dest) const
+const MulticastRoutes& RoutingTable::getMulticastRoutesFor(const IPAddress& dest) const
 {
     Enter_Method("getMulticastRoutesFor(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here here
 
-    MulticastRoutes res;
-    res.reserve(16);
-    for (RouteVector::const_iterator i=multicastRoutes.begin(); i!=multicastRoutes.end(); ++i)
+    MulticastRoutingCache::const_iterator cit = multicastRoutingCache.find(dest);
+    if (cit != multicastRoutingCache.end())
+        return cit->second;
+
+    // Not in the cache. The routes must be returned in table order: without
+    // wildcard routes, the routes of the group are exactly the matching ones
+    // (and they are kept in table order); otherwise the whole table is
+    // scanned, so that group and wildcard routes stay interleaved as in the
+    // table. Groups without routes are not cached, so that the cache only
+    // grows with the number of groups that are actually routed.
+    static const MulticastRoutes noRoutes;
+    const RouteVector *candidates = &multicastRoutes;
+    if (numWildcardMulticastRoutes==0)
+    {
+        MulticastGroupIndex::const_iterator git = multicastGroupRoutes.find(dest);
+        if (git == multicastGroupRoutes.end())
+            return noRoutes;
+        candidates = &git->second;
+    }
+    MulticastRoutes result;
+    for (RouteVector::const_iterator i=candidates->begin(); i!=candidates->end(); ++i)
     {
         const IPRoute *e = *i;
         if (IPAddress::maskedAddrAreEqual(dest, e->getHost(), e->getNetmask()))
@@ -373,9 +428,16 @@ MulticastRoutes RoutingTable::getMulticastRoutesFor(const IPAddress& dest) const
             MulticastRoute r;
             r.interf = e->getInterface();
             r.gateway = e->getGateway();
-            res.push_back(r);
+            result.push_back(r);
         }
     }
+    if (result.empty())
+        return noRoutes;
+
+    if (maxMulticastCacheSize>0 && (int)multicastRoutingCache.size()>=maxMulticastCacheSize)
+        multicastRoutingCache.clear();
+    MulticastRoutes& res = multicastRoutingCache[dest];
+    res.swap(result);
     return res;
 }
 
@@ -438,7 +500,10 @@ void RoutingTable::addRoute(const IPRoute *entry)
     if (!entry->getHost().isMulticast())
         routes.push_back(const_cast<IPRoute*>(entry));
     else
+    {
         multicastRoutes.push_back(const_cast<IPRoute*>(entry));
+        indexMulticastRoute(const_cast<IPRoute*>(entry));
+    }
 
     invalidateCache();
     updateDisplayString();
@@ -456,6 +521,7 @@ bool RoutingTable::deleteRoute(const IPRoute *entry)
     {
         nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, entry); // rather: going to be deleted
         routes.erase(i);
+        nb->forgetDetails(entry);
         delete entry;
         invalidateCache();
         updateDisplayString();
@@ -466,6 +532,8 @@ bool RoutingTable::deleteRoute(const IPRoute *entry)
     {
         nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, entry); // rather: going to be deleted
         multicastRoutes.erase(i);
+        unindexMulticastRoute(const_cast<IPRoute*>(entry));
+        nb->forgetDetails(entry);
         delete entry;
         invalidateCache();
         updateDisplayString();
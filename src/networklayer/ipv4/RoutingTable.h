@@ -31,6 +31,7 @@
 #include <vector>
 #include <omnetpp.h>
 #include "INETDefs.h"
+#include "INETHash.h"
 #include "IPAddress.h"
 #include "IInterfaceTable.h"
 #include "NotificationBoard.h"
@@ -93,6 +94,20 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     typedef std::set<IPAddress> AddressSet;
     mutable AddressSet localAddresses;
 
+    // multicast forwarding index: routes with an all-ones netmask are keyed
+    // by group address (in table order); routes with other netmasks are
+    // only counted, because they are matched by scanning the whole table
+    typedef inet_hash::unordered_map<IPAddress, RouteVector, IPAddressHash> MulticastGroupIndex;
+    MulticastGroupIndex multicastGroupRoutes;
+    int numWildcardMulticastRoutes;
+
+    // multicast routing cache: maps group address to the outgoing interfaces;
+    // groups without routes are not cached, and the cache is cleared when it
+    // would grow beyond maxMulticastCacheSize entries
+    typedef inet_hash::unordered_map<IPAddress, MulticastRoutes, IPAddressHash> MulticastRoutingCache;
+    mutable MulticastRoutingCache multicastRoutingCache;
+    int maxMulticastCacheSize; // 0 means unlimited
+
   protected:
     // set IP address etc on local loopback
     virtual void configureLoopbackForIPv4();
@@ -114,6 +129,10 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     // delete routes for the given interface
     virtual void deleteInterfaceRoutes(InterfaceEntry *entry);
 
+    // add/remove a multicast route to/from the multicast forwarding index
+    virtual void indexMulticastRoute(IPRoute *entry);
+    virtual void unindexMulticastRoute(IPRoute *entry);
+
     // invalidates routing cache and local addresses cache
     virtual void invalidateCache();
 
@@ -207,9 +226,13 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     virtual bool isLocalMulticastAddress(const IPAddress& dest) const;
 
     /**
-     * Returns routes for a multicast address.
+     * Returns routes for a multicast address, in the order they are in the
+     * table (i.e. the order they were added). The result is cached per
+     * group (up to maxMulticastCacheSize groups); the returned list is
+     * valid until the next call, or until the routing table or the
+     * interfaces change.
      */
-    virtual MulticastRoutes getMulticastRoutesFor(const IPAddress& dest) const;
+    virtual const MulticastRoutes& getMulticastRoutesFor(const IPAddress& dest) const;
     //@}
 
     /** @name Route table manipulation */
@@ -23,8 +23,37 @@
 //FIXME invoked changed() from state-changing methods, to trigger notification...
 
 
+void IPv6LocalAddressSet::addEntry(const IPv6Address& addr)
+{
+    addressCounts[addr]++;
+}
+
+void IPv6LocalAddressSet::removeEntry(const IPv6Address& addr)
+{
+    AddressCounts::iterator it = addressCounts.find(addr);
+    ASSERT(it!=addressCounts.end());
+    if (--it->second == 0)
+        addressCounts.erase(it);
+}
+
+void IPv6LocalAddressSet::add(const IPv6Address& addr)
+{
+    addEntry(addr);
+    addEntry(addr.formSolicitedNodeMulticastAddress());
+}
+
+void IPv6LocalAddressSet::remove(const IPv6Address& addr)
+{
+    removeEntry(addr);
+    removeEntry(addr.formSolicitedNodeMulticastAddress());
+}
+
+//----
+
 IPv6InterfaceData::IPv6InterfaceData()
 {
+    localAddressSet = NULL;
+
     /*******************Setting host/node/router Protocol Constants************/
     routerConstants.maxInitialRtrAdvertInterval = IPv6_MAX_INITIAL_RTR_ADVERT_INTERVAL;
     routerConstants.maxInitialRtrAdvertisements = IPv6_MAX_INITIAL_RTR_ADVERTISEMENTS;
@@ -134,6 +163,20 @@ std::string IPv6InterfaceData::detailedInfo() const
     return info(); // TBD this could be improved: multi-line text, etc
 }
 
+void IPv6InterfaceData::setLocalAddressSet(IPv6LocalAddressSet *set)
+{
+    if (set==localAddressSet)
+        return;
+    for (AddressDataVector::const_iterator it=addresses.begin(); it!=addresses.end(); it++)
+    {
+        if (localAddressSet)
+            localAddressSet->remove(it->address);
+        if (set)
+            set->add(it->address);
+    }
+    localAddressSet = set;
+}
+
 void IPv6InterfaceData::assignAddress(const IPv6Address& addr, bool tentative,
                                       simtime_t expiryTime, simtime_t prefExpiryTime)
 {
@@ -143,6 +186,8 @@ void IPv6InterfaceData::assignAddress(const IPv6Address& addr, bool tentative,
     a.tentative = tentative;
     a.expiryTime = expiryTime;
     a.prefExpiryTime = prefExpiryTime;
+    if (localAddressSet)
+        localAddressSet->add(addr);
     choosePreferredAddress();
 }
 
@@ -220,6 +265,8 @@ void IPv6InterfaceData::removeAddress(const IPv6Address& address)
     int k = findAddress(address);
     ASSERT(k!=-1);
     addresses.erase(addresses.begin()+k);
+    if (localAddressSet)
+        localAddressSet->remove(address);
     choosePreferredAddress();
 }
 
@@ -24,6 +24,7 @@
 #include <vector>
 #include <omnetpp.h>
 #include "INETDefs.h"
+#include "INETHash.h"
 #include "IPv6Address.h"
 #include "InterfaceEntry.h"
 
@@ -62,6 +63,42 @@
 #define IPv6_MAX_RANDOM_FACTOR              1.5
 /***************END of RFC 2461 Protocol Constants*****************************/
 
+/**
+ * Set of the addresses assigned to the IPv6 interfaces of a node, plus
+ * the solicited-node multicast addresses formed from them. Entries are
+ * reference counted, because the same address may be assigned several
+ * times (also on different interfaces). It is owned by RoutingTable6 and
+ * kept up to date by IPv6InterfaceData, so that isLocalAddress() needs
+ * only a single hash lookup.
+ */
+class INET_API IPv6LocalAddressSet
+{
+  protected:
+    typedef inet_hash::unordered_map<IPv6Address,int,IPv6AddressHash> AddressCounts;
+    AddressCounts addressCounts;
+
+  protected:
+    void addEntry(const IPv6Address& addr);
+    void removeEntry(const IPv6Address& addr);
+
+  public:
+    /**
+     * Adds an interface address and its solicited-node multicast address.
+     */
+    void add(const IPv6Address& addr);
+
+    /**
+     * Removes an interface address and its solicited-node multicast address.
+     */
+    void remove(const IPv6Address& addr);
+
+    /**
+     * Returns true if addr is an interface address or a solicited-node
+     * multicast address of one.
+     */
+    bool contains(const IPv6Address& addr) const {return addressCounts.find(addr)!=addressCounts.end();}
+};
+
 /**
  * IPv6-specific data for InterfaceEntry. Most of this comes from
  * section 6.2.1 of RFC 2461 (IPv6 Neighbor Discovery, Router Configuration
@@ -138,6 +175,7 @@ class INET_API IPv6InterfaceData : public InterfaceProtocolData
     AddressDataVector addresses;   // interface addresses
     IPv6Address preferredAddr; // cached result of preferred address selection
     simtime_t preferredAddrExpiryTime;
+    IPv6LocalAddressSet *localAddressSet; // node-wide set to keep in sync with addresses, or NULL
 
     /***************RFC 2462: Section 5.1 Node Configuration Variables*********/
     struct NodeVariables
@@ -315,6 +353,13 @@ class INET_API IPv6InterfaceData : public InterfaceProtocolData
 
     /** @name Addresses */
     //@{
+    /**
+     * Sets the node-wide address set to be updated when addresses are assigned
+     * or removed; the current addresses get removed from the old set and added
+     * to the new one. NULL is allowed. The destructor does not touch the set.
+     */
+    virtual void setLocalAddressSet(IPv6LocalAddressSet *set);
+
     /**
      * Assigns the given address to the interface.
      */
@@ -0,0 +1,170 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include "IPv6RouteTrie.h"
+#include "RoutingTable6.h"
+
+
+IPv6RouteTrie::Node::Node()
+{
+    for (int i=0; i<FANOUT; i++)
+        children[i] = NULL;
+    slots = NULL;
+    numRoutes = 0;
+}
+
+IPv6RouteTrie::Node::~Node()
+{
+    for (int i=0; i<FANOUT; i++)
+        delete children[i];
+    delete [] slots;
+}
+
+IPv6RouteTrie::IPv6RouteTrie()
+{
+    root = new Node();
+    numRoutes = 0;
+}
+
+IPv6RouteTrie::~IPv6RouteTrie()
+{
+    delete root;
+}
+
+int IPv6RouteTrie::getSlot(const IPv6Address& prefix, int prefixLength)
+{
+    // slots: length 0: [0], length 1: [1..2], length 2: [3..6], length 3: [7..14]
+    int len = prefixLength % STRIDE;
+    if (len==0)
+        return 0;
+    return (1 << len) - 1 + (getNibble(prefix, prefixLength / STRIDE) >> (STRIDE - len));
+}
+
+static bool metricLess(const IPv6Route *a, const IPv6Route *b)
+{
+    return a->getMetric() < b->getMetric();
+}
+
+void IPv6RouteTrie::addRoute(IPv6Route *route)
+{
+    const IPv6Address& prefix = route->getDestPrefix();
+    int length = route->getPrefixLength();
+    ASSERT(length>=0 && length<=128);
+
+    Node *node = root;
+    node->numRoutes++;
+    for (int depth=0; depth < length / STRIDE; depth++)
+    {
+        Node *&child = node->children[getNibble(prefix, depth)];
+        if (!child)
+            child = new Node();
+        node = child;
+        node->numRoutes++;
+    }
+
+    if (!node->slots)
+        node->slots = new RouteList[SLOTS];
+    RouteList& list = node->slots[getSlot(prefix, length)];
+    list.insert(std::upper_bound(list.begin(), list.end(), route, metricLess), route);
+    numRoutes++;
+}
+
+bool IPv6RouteTrie::removeRoute(IPv6Route *route)
+{
+    const IPv6Address& prefix = route->getDestPrefix();
+    int length = route->getPrefixLength();
+
+    Node *path[MAX_DEPTH+1];
+    Node *node = root;
+    int depth = 0;
+    path[0] = root;
+    for (; depth < length / STRIDE; depth++)
+    {
+        node = node->children[getNibble(prefix, depth)];
+        if (!node)
+            return false;
+        path[depth+1] = node;
+    }
+
+    if (!node->slots)
+        return false;
+    RouteList& list = node->slots[getSlot(prefix, length)];
+    RouteList::iterator it = std::find(list.begin(), list.end(), route);
+    if (it==list.end())
+        return false;
+    list.erase(it);
+    numRoutes--;
+
+    // update route counts on the path, and free the nodes that became empty
+    for (int d=depth; d>=0; d--)
+    {
+        Node *n = path[d];
+        if (--n->numRoutes==0 && d>0)
+        {
+            path[d-1]->children[getNibble(prefix, d-1)] = NULL;
+            delete n;
+        }
+    }
+    if (root->numRoutes==0)
+    {
+        delete [] root->slots;
+        root->slots = NULL;
+    }
+    return true;
+}
+
+void IPv6RouteTrie::clear()
+{
+    delete root;
+    root = new Node();
+    numRoutes = 0;
+}
+
+int IPv6RouteTrie::findMatches(const IPv6Address& dest, const RouteList *matches[]) const
+{
+    int numMatches = 0;
+    const Node *node = root;
+    for (int depth=0; node; depth++)
+    {
+        if (node->slots)
+        {
+            // prefixes of length 0..3 within this node
+            const RouteList *slots = node->slots;
+            if (!slots[0].empty())
+                matches[numMatches++] = &slots[0];
+            if (depth==MAX_DEPTH)
+                break;
+            int nibble = getNibble(dest, depth);
+            for (int len=1; len<STRIDE; len++)
+            {
+                const RouteList& list = slots[(1 << len) - 1 + (nibble >> (STRIDE - len))];
+                if (!list.empty())
+                    matches[numMatches++] = &list;
+            }
+            node = node->children[nibble];
+        }
+        else
+        {
+            if (depth==MAX_DEPTH)
+                break;
+            node = node->children[getNibble(dest, depth)];
+        }
+    }
+    return numMatches;
+}
+
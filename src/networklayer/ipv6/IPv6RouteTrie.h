@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPV6ROUTETRIE_H
+#define __INET_IPV6ROUTETRIE_H
+
+#include <vector>
+#include "INETDefs.h"
+#include "IPv6Address.h"
+
+class IPv6Route;
+
+
+/**
+ * Multibit trie for longest prefix matching on IPv6 routes, used by
+ * RoutingTable6. Each trie node consumes 4 bits (a nibble) of the address,
+ * so a lookup visits at most 33 nodes regardless of the number of routes.
+ *
+ * A route is stored in the node where its prefix ends: a prefix of length
+ * L goes into the node at depth L/4, in one of the 15 slots that represent
+ * the prefixes of length 0..3 within the node (1+2+4+8 slots). Routes with
+ * the same prefix are kept in a list sorted by metric; routes with equal
+ * metric stay in insertion order.
+ */
+class INET_API IPv6RouteTrie
+{
+  public:
+    typedef std::vector<IPv6Route *> RouteList;
+
+    enum {
+        STRIDE = 4,
+        FANOUT = 1 << STRIDE,
+        SLOTS = FANOUT - 1,
+        MAX_DEPTH = 128 / STRIDE,
+        MAX_MATCHES = 129   // one per possible prefix length
+    };
+
+  protected:
+    struct Node
+    {
+        Node *children[FANOUT];
+        RouteList *slots;   // array of SLOTS lists, or NULL if no route ends here
+        int numRoutes;      // number of routes in this node and below
+        Node();
+        ~Node();
+    };
+
+    Node *root;
+    int numRoutes;
+
+  protected:
+    static int getNibble(const IPv6Address& addr, int depth) {
+        return (addr.words()[depth >> 3] >> (28 - STRIDE * (depth & 7))) & (FANOUT - 1);
+    }
+    static int getSlot(const IPv6Address& prefix, int prefixLength);
+
+  public:
+    IPv6RouteTrie();
+    ~IPv6RouteTrie();
+
+    /**
+     * Inserts the route, after the routes with the same prefix and a
+     * smaller or equal metric. Neither the prefix nor the metric of the
+     * route may change while it is in the trie.
+     */
+    void addRoute(IPv6Route *route);
+
+    /**
+     * Removes the route; returns false if it was not in the trie.
+     */
+    bool removeRoute(IPv6Route *route);
+
+    /**
+     * Removes all routes (the routes themselves are not deleted).
+     */
+    void clear();
+
+    /**
+     * Collects the route lists whose prefix matches dest, from the shortest
+     * prefix to the longest one, and returns their number. The matches
+     * array must have room for MAX_MATCHES elements. The returned lists
+     * are only valid until the trie is modified.
+     */
+    int findMatches(const IPv6Address& dest, const RouteList *matches[]) const;
+
+    /**
+     * Returns the number of routes in the trie.
+     */
+    int getNumRoutes() const {return numRoutes;}
+};
+
+#endif
+
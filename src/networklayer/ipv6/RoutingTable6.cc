@@ -27,6 +27,11 @@
 
 Define_Module(RoutingTable6);
 
+// for Enter_Method(): prints the address as 8 hex groups, because str() is too slow
+#define IPV6_FMT  "%x:%x:%x:%x:%x:%x:%x:%x"
+#define IPV6_ARGS(a)  (a).words()[0]>>16, (a).words()[0]&0xffff, (a).words()[1]>>16, (a).words()[1]&0xffff, \
+                      (a).words()[2]>>16, (a).words()[2]&0xffff, (a).words()[3]>>16, (a).words()[3]&0xffff
+
 
 std::string IPv6Route::info() const
 {
@@ -64,14 +69,20 @@ std::ostream& operator<<(std::ostream& os, const IPv6Route& e)
     return os;
 };
 
-std::ostream& operator<<(std::ostream& os, const RoutingTable6::DestCacheEntry& e)
+std::ostream& operator<<(std::ostream& os, const RoutingTable6::DestCache& destCache)
 {
-    os << "if=" << e.interfaceId << " " << e.nextHopAddr;  //FIXME try printing interface name
+    // for WATCH(): WATCH_MAP only supports std::map, so the entries are
+    // printed on one line, in no particular order
+    os << destCache.size() << " entries: ";
+    for (RoutingTable6::DestCache::const_iterator it=destCache.begin(); it!=destCache.end(); ++it)
+        os << it->first << " --> if=" << it->second.interfaceId << " " << it->second.nextHopAddr << "; ";  //FIXME try printing interface name
     return os;
 };
 
 RoutingTable6::RoutingTable6()
 {
+    lruHead = lruTail = NULL;
+    maxDestCacheSize = 0;
 }
 
 RoutingTable6::~RoutingTable6()
@@ -94,9 +105,12 @@ void RoutingTable6::initialize(int stage)
         nb->subscribe(this, NF_INTERFACE_IPv6CONFIG_CHANGED);
 
         WATCH_PTRVECTOR(routeList);
-        WATCH_MAP(destCache); // FIXME commented out for now
+        WATCH(destCache);
         isrouter = par("isRouter");
         WATCH(isrouter);
+        maxDestCacheSize = par("maxDestCacheSize");
+        if (maxDestCacheSize<0)
+            error("maxDestCacheSize must not be negative");
 
         // add IPv6InterfaceData to interfaces
         for (int i=0; i<ift->getNumInterfaces(); i++)
@@ -198,6 +212,11 @@ void RoutingTable6::receiveChangeNotification(int category, const cPolymorphic *
     }
     else if (category==NF_INTERFACE_DELETED)
     {
+        // the interface's addresses are no longer ours
+        InterfaceEntry *ie = check_and_cast<InterfaceEntry*>(details);
+        if (ie->ipv6Data())
+            ie->ipv6Data()->setLocalAddressSet(NULL);
+
         //TODO remove all routes that point to that interface (?)
     }
     else if (category==NF_INTERFACE_STATE_CHANGED)
@@ -225,6 +244,9 @@ void RoutingTable6::configureInterfaceForIPv6(InterfaceEntry *ie)
     //as a host?
     ipv6IfData->setAdvSendAdvertisements(isrouter);//Added by WEI
 
+    // let isLocalAddress() know about the addresses assigned to the interface
+    ipv6IfData->setLocalAddressSet(&localAddresses);
+
     // metric: some hints: OSPF cost (2e9/bps value), MS KB article Q299540, ...
     //d->setMetric((int)ceil(2e9/ie->getDatarate())); // use OSPF cost as default
     //FIXME TBD fill in the rest
@@ -353,9 +375,9 @@ void RoutingTable6::configureInterfaceFromXML(InterfaceEntry *ie, cXMLElement *c
 
 InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 {
-    Enter_Method("getInterfaceByAddress(%s)=?", addr.str().c_str());
+    Enter_Method("getInterfaceByAddress(" IPV6_FMT ")=?", IPV6_ARGS(addr));
 
-    if (addr.isUnspecified())
+    if (addr.isUnspecified() || !localAddresses.contains(addr))
         return NULL;
     for (int i=0; i<ift->getNumInterfaces(); ++i)
     {
@@ -368,15 +390,12 @@ InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 
 bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
 {
-    Enter_Method("isLocalAddress(%s) y/n", dest.str().c_str());
+    Enter_Method("isLocalAddress(" IPV6_FMT ") y/n", IPV6_ARGS(dest));
 
-    // first, check if we have an interface with this address
-    for (int i=0; i<ift->getNumInterfaces(); i++)
-    {
-        InterfaceEntry *ie = ift->getInterface(i);
-        if (ie->ipv6Data()->hasAddress(dest))
-            return true;
-    }
+    // first, check if we have an interface with this address, or it is
+    // the solicited-node multicast address of one of our addresses
+    if (localAddresses.contains(dest))
+        return true;
 
     // then check for special, preassigned multicast addresses
     // (these addresses occur more rarely than specific interface addresses,
@@ -386,23 +405,12 @@ bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
         return true;
     if (isRouter() && (dest==IPv6Address::ALL_ROUTERS_1 || dest==IPv6Address::ALL_ROUTERS_2 || dest==IPv6Address::ALL_ROUTERS_5))
         return true;
-
-    // check for solicited-node multicast address
-    if (dest.matches(IPv6Address::SOLICITED_NODE_PREFIX, 104))
-    {
-        for (int i=0; i<ift->getNumInterfaces(); i++)
-        {
-            InterfaceEntry *ie = ift->getInterface(i);
-            if (ie->ipv6Data()->matchesSolicitedNodeMulticastAddress(dest))
-                return true;
-        }
-    }
     return false;
 }
 
 const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int& outInterfaceId) const
 {
-    Enter_Method("lookupDestCache(%s)", dest.str().c_str());
+    Enter_Method("lookupDestCache(" IPV6_FMT ")", IPV6_ARGS(dest));
 
     DestCache::const_iterator it = destCache.find(dest);
     if (it == destCache.end())
@@ -410,33 +418,46 @@ const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int&
         outInterfaceId = -1;
         return IPv6Address::UNSPECIFIED_ADDRESS;
     }
+    touchDestCacheEntry(&it->second);
     outInterfaceId = it->second.interfaceId;
     return it->second.nextHopAddr;
 }
 
 const IPv6Route *RoutingTable6::doLongestPrefixMatch(const IPv6Address& dest)
 {
-    Enter_Method("doLongestPrefixMatch(%s)", dest.str().c_str());
+    Enter_Method("doLongestPrefixMatch(" IPV6_FMT ")", IPV6_ARGS(dest));
 
-    // we'll just stop at the first match, because the table is sorted
-    // by prefix lengths and metric (see addRoute())
-    for (RouteList::const_iterator it=routeList.begin(); it!=routeList.end(); it++)
+    // the trie returns the matching routes grouped by prefix, shortest prefix
+    // first, and sorted by metric within the group; we take the first one
+    // from the longest prefix that is not expired
+    const IPv6RouteTrie::RouteList *matches[IPv6RouteTrie::MAX_MATCHES];
+    int numMatches = routeTrie.findMatches(dest, matches);
+
+    const IPv6Route *result = NULL;
+    std::vector<IPv6Route *> expiredRoutes;
+    for (int i=numMatches-1; i>=0 && !result; i--)
     {
-        if (dest.matches((*it)->getDestPrefix(),(*it)->getPrefixLength()))
+        const IPv6RouteTrie::RouteList& routes = *matches[i];
+        for (IPv6RouteTrie::RouteList::const_iterator it=routes.begin(); it!=routes.end(); it++)
         {
-            // FIXME proofread this code, iterator invalidation-wise, etc
-            bool entryExpired = false;
             if (simTime() > (*it)->getExpiryTime() && (*it)->getExpiryTime() != 0)//since 0 represents infinity.
             {
                 EV << "Expired prefix detected!!" << endl;
-                removeOnLinkPrefix((*it)->getDestPrefix(), (*it)->getPrefixLength());
-                entryExpired = true;
+                expiredRoutes.push_back(*it);
+            }
+            else
+            {
+                result = *it;
+                break;
             }
-            if (entryExpired == false) return *it;
         }
     }
-    // FIXME todo: if we selected an expired route, throw it out and select again!
-    return NULL;
+
+    // remove expired prefixes only now, because removal invalidates matches[]
+    for (unsigned int i=0; i<expiredRoutes.size(); i++)
+        removeOnLinkPrefix(expiredRoutes[i]->getDestPrefix(), expiredRoutes[i]->getPrefixLength());
+
+    return result;
 }
 
 bool RoutingTable6::isPrefixPresent(const IPv6Address& prefix) const
@@ -447,11 +468,85 @@ bool RoutingTable6::isPrefixPresent(const IPv6Address& prefix) const
     return false;
 }
 
+void RoutingTable6::touchDestCacheEntry(const DestCacheEntry *centry) const
+{
+    // move to the front of the LRU list
+    DestCacheEntry *entry = const_cast<DestCacheEntry *>(centry);
+    if (entry==lruHead)
+        return;
+    unlinkFromLRU(entry);
+    entry->lruNext = lruHead;
+    if (lruHead)
+        lruHead->lruPrev = entry;
+    lruHead = entry;
+    if (!lruTail)
+        lruTail = entry;
+}
+
+void RoutingTable6::unlinkFromLRU(DestCacheEntry *entry) const
+{
+    if (entry->lruPrev)
+        entry->lruPrev->lruNext = entry->lruNext;
+    else if (lruHead==entry)
+        lruHead = entry->lruNext;
+    if (entry->lruNext)
+        entry->lruNext->lruPrev = entry->lruPrev;
+    else if (lruTail==entry)
+        lruTail = entry->lruPrev;
+    entry->lruPrev = entry->lruNext = NULL;
+}
+
+void RoutingTable6::linkToNeighbour(DestCacheEntry *entry)
+{
+    DestCacheEntry *&head = destCacheByNeighbour[NeighbourKey(entry->nextHopAddr, entry->interfaceId)];
+    entry->neighbourPrev = NULL;
+    entry->neighbourNext = head;
+    if (head)
+        head->neighbourPrev = entry;
+    head = entry;
+}
+
+void RoutingTable6::unlinkFromNeighbour(DestCacheEntry *entry)
+{
+    if (entry->neighbourPrev)
+        entry->neighbourPrev->neighbourNext = entry->neighbourNext;
+    else
+    {
+        DestCacheByNeighbour::iterator it = destCacheByNeighbour.find(NeighbourKey(entry->nextHopAddr, entry->interfaceId));
+        ASSERT(it!=destCacheByNeighbour.end() && it->second==entry);
+        if (entry->neighbourNext)
+            it->second = entry->neighbourNext;
+        else
+            destCacheByNeighbour.erase(it);
+    }
+    if (entry->neighbourNext)
+        entry->neighbourNext->neighbourPrev = entry->neighbourPrev;
+    entry->neighbourPrev = entry->neighbourNext = NULL;
+}
+
+void RoutingTable6::removeDestCacheEntry(DestCacheEntry *entry)
+{
+    unlinkFromLRU(entry);
+    unlinkFromNeighbour(entry);
+    IPv6Address destAddr = entry->destAddr; // copy: the key must not be part of the erased element
+    destCache.erase(destAddr);
+}
+
 void RoutingTable6::updateDestCache(const IPv6Address& dest, const IPv6Address& nextHopAddr, int interfaceId)
 {
-    // FIXME this performs 2 lookups -- optimize to do only one
-    destCache[dest].nextHopAddr = nextHopAddr;
-    destCache[dest].interfaceId = interfaceId;
+    std::pair<DestCache::iterator,bool> res = destCache.insert(DestCache::value_type(dest, DestCacheEntry()));
+    DestCacheEntry& entry = res.first->second;
+    if (res.second)
+        entry.destAddr = dest;
+    else
+        unlinkFromNeighbour(&entry);
+    entry.nextHopAddr = nextHopAddr;
+    entry.interfaceId = interfaceId;
+    linkToNeighbour(&entry);
+    touchDestCacheEntry(&entry);
+
+    if (maxDestCacheSize>0 && (int)destCache.size()>maxDestCacheSize)
+        removeDestCacheEntry(lruTail);
 
     updateDisplayString();
 }
@@ -459,23 +554,26 @@ void RoutingTable6::updateDestCache(const IPv6Address& dest, const IPv6Address&
 void RoutingTable6::purgeDestCache()
 {
     destCache.clear();
+    destCacheByNeighbour.clear();
+    lruHead = lruTail = NULL;
     updateDisplayString();
 }
 
 void RoutingTable6::purgeDestCacheEntriesToNeighbour(const IPv6Address& nextHopAddr, int interfaceId)
 {
-    for (DestCache::iterator it=destCache.begin(); it!=destCache.end(); )
+    DestCacheByNeighbour::iterator it = destCacheByNeighbour.find(NeighbourKey(nextHopAddr, interfaceId));
+    if (it==destCacheByNeighbour.end())
+        return;
+
+    DestCacheEntry *entry = it->second;
+    destCacheByNeighbour.erase(it);
+    while (entry)
     {
-        if (it->second.interfaceId==interfaceId && it->second.nextHopAddr==nextHopAddr)
-        {
-            // move the iterator past this element before removing it
-            DestCache::iterator oldIt = it++;
-            destCache.erase(oldIt);
-        }
-        else
-        {
-            it++;
-        }
+        DestCacheEntry *next = entry->neighbourNext;
+        unlinkFromLRU(entry);
+        IPv6Address destAddr = entry->destAddr;
+        destCache.erase(destAddr);
+        entry = next;
     }
 
     updateDisplayString();
@@ -564,6 +662,7 @@ void RoutingTable6::removeOnLinkPrefix(const IPv6Address& destPrefix, int prefix
     {
         if ((*it)->getSrc()==IPv6Route::FROM_RA && (*it)->getDestPrefix()==destPrefix && (*it)->getPrefixLength()==prefixLength)
         {
+            routeTrie.removeRoute(*it);
             routeList.erase(it);
             return; // there can be only one such route, addOrUpdateOnLinkPrefix() guarantees that
         }
@@ -619,11 +718,10 @@ bool RoutingTable6::routeLessThan(const IPv6Route *a, const IPv6Route *b)
 
 void RoutingTable6::addRoute(IPv6Route *route)
 {
-    routeList.push_back(route);
-
-    // we keep entries sorted by prefix length in routeList, so that we can
-    // stop at the first match when doing the longest prefix matching
-    std::sort(routeList.begin(), routeList.end(), routeLessThan);
+    // we keep entries sorted by prefix length and metric in routeList;
+    // longest prefix matching is done with routeTrie
+    routeList.insert(std::upper_bound(routeList.begin(), routeList.end(), route, routeLessThan), route);
+    routeTrie.addRoute(route);
 
     updateDisplayString();
 
@@ -638,6 +736,8 @@ void RoutingTable6::removeRoute(IPv6Route *route)
     nb->fireChangeNotification(NF_IPv6_ROUTE_DELETED, route); // rather: going to be deleted
 
     routeList.erase(it);
+    routeTrie.removeRoute(route);
+    nb->forgetDetails(route);
     delete route;
 
     updateDisplayString();
@@ -21,7 +21,10 @@
 #include <vector>
 #include <omnetpp.h>
 #include "INETDefs.h"
+#include "INETHash.h"
 #include "IPv6Address.h"
+#include "IPv6RouteTrie.h"
+#include "IPv6InterfaceData.h"
 #include "IInterfaceTable.h"
 #include "NotificationBoard.h"
 
@@ -107,23 +110,55 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable
 
     bool isrouter;
 
+    // addresses of the interfaces and their solicited-node multicast
+    // addresses, for isLocalAddress(); updated by IPv6InterfaceData
+    IPv6LocalAddressSet localAddresses;
+
     // Destination Cache maps dest address to next hop and interfaceId.
+    // It is a hash table limited to maxDestCacheSize entries; when it is full,
+    // the least recently used entry is evicted. Entries are also linked into
+    // per-neighbour lists (next hop + interface), so that purging the entries
+    // to a neighbour does not need to scan the whole cache.
     // NOTE: nextHop might be a link-local address from which interfaceId cannot be deduced
     struct DestCacheEntry
     {
+        IPv6Address destAddr;
         int interfaceId;
         IPv6Address nextHopAddr;
         // more destination specific data may be added here, e.g. path MTU
+
+        mutable DestCacheEntry *lruPrev, *lruNext; // LRU list, most recently used first
+        DestCacheEntry *neighbourPrev, *neighbourNext; // entries with the same next hop and interface
+        DestCacheEntry() : interfaceId(-1), lruPrev(NULL), lruNext(NULL), neighbourPrev(NULL), neighbourNext(NULL) {}
+    };
+    struct NeighbourKey
+    {
+        IPv6Address addr;
+        int interfaceId;
+        NeighbourKey(const IPv6Address& addr, int interfaceId) : addr(addr), interfaceId(interfaceId) {}
+        bool operator==(const NeighbourKey& other) const {return interfaceId==other.interfaceId && addr==other.addr;}
     };
-    friend std::ostream& operator<<(std::ostream& os, const DestCacheEntry& e);
-    typedef std::map<IPv6Address,DestCacheEntry> DestCache;
+    struct NeighbourKeyHash
+    {
+        size_t operator()(const NeighbourKey& key) const {return inet_hash_combine(IPv6AddressHash()(key.addr), key.interfaceId);}
+    };
+    typedef inet_hash::unordered_map<IPv6Address,DestCacheEntry,IPv6AddressHash> DestCache;
+    friend std::ostream& operator<<(std::ostream& os, const DestCache& destCache);
+    typedef inet_hash::unordered_map<NeighbourKey,DestCacheEntry*,NeighbourKeyHash> DestCacheByNeighbour;
     DestCache destCache;
+    DestCacheByNeighbour destCacheByNeighbour; // heads of the per-neighbour lists
+    mutable DestCacheEntry *lruHead; // most recently used
+    mutable DestCacheEntry *lruTail; // least recently used, evicted first
+    int maxDestCacheSize; // 0 means unlimited
 
     // RouteList contains local prefixes, and (for routers)
     // static, OSPF, RIP etc routes as well
     typedef std::vector<IPv6Route*> RouteList;
     RouteList routeList;
 
+    // the same routes, indexed for longest prefix matching
+    IPv6RouteTrie routeTrie;
+
   protected:
     // internal: routes of different type can only be added via well-defined functions
     virtual void addRoute(IPv6Route *route);
@@ -140,6 +175,13 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable
     // internal
     virtual void configureInterfaceFromXML(InterfaceEntry *ie, cXMLElement *cfg);
 
+    // destination cache internals
+    void touchDestCacheEntry(const DestCacheEntry *entry) const;
+    void unlinkFromLRU(DestCacheEntry *entry) const;
+    void linkToNeighbour(DestCacheEntry *entry);
+    void unlinkFromNeighbour(DestCacheEntry *entry);
+    void removeDestCacheEntry(DestCacheEntry *entry);
+
   protected:
     // displays summary above the icon
     virtual void updateDisplayString();
@@ -135,9 +135,11 @@ void LDP::initialize(int stage)
     // build list of recognized FECs
     rebuildFecList();
 
-    // listen for routing table modifications
-    nb->subscribe(this, NF_IPv4_ROUTE_ADDED);
-    nb->subscribe(this, NF_IPv4_ROUTE_DELETED);
+    // listen for routing table modifications; the FEC list is rebuilt from
+    // scratch, so one notification per time step is enough (TED rebuilds the
+    // whole routing table at once)
+    nb->subscribeDeferred(this, NF_IPv4_ROUTE_ADDED);
+    nb->subscribeDeferred(this, NF_IPv4_ROUTE_DELETED);
 }
 
 void LDP::handleMessage(cMessage *msg)
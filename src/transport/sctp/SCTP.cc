@@ -106,6 +106,7 @@ void SCTP::initialize()
     numPacketsReceived = 0;
     numPacketsDropped = 0;
     sizeConnMap = 0;
+    timerWheel.init(this, par("timerGranularity"));
     if ((bool)par("udpEncapsEnabled"))
         bindPortForUDP();
 }
@@ -143,7 +144,20 @@ void SCTP::handleMessage(cMessage *msg)
 
     sctpEV3 << "\n\nSCTPMain handleMessage at " << getFullPath() << "\n";
 
-    if (msg->isSelfMessage())
+    if (timerWheel.isTickMessage(msg))
+    {
+        WheelTimer *timer;
+        while ((timer = timerWheel.popExpired()) != NULL)
+        {
+            SCTPAssociation *assoc = (SCTPAssociation *) timer->getContextPointer();
+            bool ret = assoc->processTimer(timer);
+
+            if (!ret)
+                removeAssociation(assoc);
+        }
+        timerWheel.rearm();
+    }
+    else if (msg->isSelfMessage())
     {
 
         sctpEV3 << "selfMessage\n";
@@ -889,4 +903,8 @@ void SCTP::finish()
         recordScalar("Packets Dropped",      numPacketsDropped);
 
     }
+
+    // same names as in TCP
+    recordScalar("timers scheduled", timerWheel.getNumTimersScheduled());
+    recordScalar("timer events", timerWheel.getNumTickEvents());
 }
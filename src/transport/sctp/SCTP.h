@@ -27,6 +27,7 @@
 #include <map>
 #include "IPvXAddress.h"
 #include "UDPSocket.h"
+#include "TimerWheel.h"
 
 
 class SCTPAssociation;
@@ -186,6 +187,7 @@ class INET_API SCTP : public cSimpleModule
     void removeAssociation(SCTPAssociation *assoc);
 
     simtime_t testTimeout;
+    TimerWheel timerWheel;  // drives the association and path timers
     uint32 numGapReports;
     uint32 numPacketsReceived;
     uint32 numPacketsDropped;
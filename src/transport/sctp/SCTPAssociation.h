@@ -241,10 +241,10 @@ class INET_API SCTPPathVariables : public cPolymorphic
         bool                lowestTSNRetransmitted;         // T.D. 08.12.2009
 
         // ====== Timers ======================================================
-        cMessage*           HeartbeatTimer;
-        cMessage*           HeartbeatIntervalTimer;
-        cMessage*           CwndTimer;
-        cMessage*           T3_RtxTimer;
+        WheelTimer*         HeartbeatTimer;
+        WheelTimer*         HeartbeatIntervalTimer;
+        WheelTimer*         CwndTimer;
+        WheelTimer*         T3_RtxTimer;
 
         // ====== Path Status =================================================
         simtime_t           heartbeatTimeout;
@@ -531,10 +531,10 @@ class INET_API SCTPAssociation : public cObject
     bool                    listen;
 
     // Timers
-    cMessage*               T1_InitTimer;
-    cMessage*               T2_ShutdownTimer;
-    cMessage*               T5_ShutdownGuardTimer;
-    cMessage*               SackTimer;
+    WheelTimer*             T1_InitTimer;
+    WheelTimer*             T2_ShutdownTimer;
+    WheelTimer*             T5_ShutdownGuardTimer;
+    WheelTimer*             SackTimer;
     cMessage*               StartTesting;
 
   protected:
@@ -597,9 +597,9 @@ class INET_API SCTPAssociation : public cObject
     inline SCTPAlgorithm* getSctpAlgorithm() const { return sctpAlgorithm; };
     inline SCTP* getSctpMain() const { return sctpMain; };
     inline cFSM* getFsm() const { return fsm; };
-    inline cMessage* getInitTimer() const { return T1_InitTimer; };
-    inline cMessage* getShutdownTimer() const { return T2_ShutdownTimer; };
-    inline cMessage* getSackTimer() const { return SackTimer; };
+    inline WheelTimer* getInitTimer() const { return T1_InitTimer; };
+    inline WheelTimer* getShutdownTimer() const { return T2_ShutdownTimer; };
+    inline WheelTimer* getSackTimer() const { return SackTimer; };
 
     /** Utility: returns name of SCTP_S_xxx constants */
     static const char* stateName(const int32 state);
@@ -626,7 +626,7 @@ class INET_API SCTPAssociation : public cObject
     void removePath();
     void removePath(const IPvXAddress& addr);
     void deleteStreams();
-    void stopTimer(cMessage* timer);
+    void stopTimer(WheelTimer* timer);
     void stopTimers();
     inline SCTPPathVariables* getPath(const IPvXAddress& pathId) const {
         SCTPPathMap::const_iterator iterator = sctpPathMap.find(pathId);
@@ -685,7 +685,7 @@ class INET_API SCTPAssociation : public cObject
     int32 updateCounters(SCTPPathVariables* path);
     //@}
 
-    void startTimer(cMessage* timer, const simtime_t& timeout);
+    void startTimer(WheelTimer* timer, const simtime_t& timeout);
 
     /** Utility: clone a listening association. Used for forking. */
     SCTPAssociation* cloneAssociation();
@@ -736,11 +736,21 @@ class INET_API SCTPAssociation : public cObject
         sctpMain->scheduleAt(simulation.getSimTime() + timeout, msg);
     }
 
+    /** Utility: start a timer in the timing wheel of the SCTP module */
+    inline void scheduleTimeout(WheelTimer* timer, const simtime_t& timeout) {
+        sctpMain->timerWheel.scheduleAt(simulation.getSimTime() + timeout, timer);
+    }
+
     /** Utility: cancel a timer */
     inline cMessage* cancelEvent(cMessage* msg) {
         return sctpMain->cancelEvent(msg);
     }
 
+    /** Utility: cancel a timer in the timing wheel of the SCTP module */
+    inline WheelTimer* cancelEvent(WheelTimer* timer) {
+        return sctpMain->timerWheel.cancel(timer);
+    }
+
     /** Utility: sends packet to application */
     void sendToApp(cPacket* msg);
 
@@ -82,13 +82,13 @@ SCTPPathVariables::SCTPPathVariables(const IPvXAddress& addr, SCTPAssociation* a
 
     char str[128];
     snprintf(str, sizeof(str), "HB_TIMER %d:%s", assoc->assocId, addr.str().c_str());
-    HeartbeatTimer = new cMessage(str);
+    HeartbeatTimer = new WheelTimer(str);
     snprintf(str, sizeof(str), "HB_INT_TIMER %d:%s", assoc->assocId, addr.str().c_str());
-    HeartbeatIntervalTimer = new cMessage(str);
+    HeartbeatIntervalTimer = new WheelTimer(str);
     snprintf(str, sizeof(str), "CWND_TIMER %d:%s", assoc->assocId, addr.str().c_str());
-    CwndTimer = new cMessage(str);
+    CwndTimer = new WheelTimer(str);
     snprintf(str, sizeof(str), "RTX_TIMER %d:%s", assoc->assocId, addr.str().c_str());
-    T3_RtxTimer = new cMessage(str);
+    T3_RtxTimer = new WheelTimer(str);
     HeartbeatTimer->setContextPointer(association);
     HeartbeatIntervalTimer->setContextPointer(association);
     CwndTimer->setContextPointer(association);
@@ -326,13 +326,13 @@ SCTPAssociation::SCTPAssociation(SCTP* _module, int32 _appGateIndex, int32 _asso
     // ====== Timers =========================================================
     char timerName[128];
     snprintf(timerName, sizeof(timerName), "T1_INIT of Association %d", assocId);
-    T1_InitTimer = new cMessage(timerName);
+    T1_InitTimer = new WheelTimer(timerName);
     snprintf(timerName, sizeof(timerName), "T2_SHUTDOWN of Association %d", assocId);
-    T2_ShutdownTimer = new cMessage(timerName);
+    T2_ShutdownTimer = new WheelTimer(timerName);
     snprintf(timerName, sizeof(timerName), "T5_SHUTDOWN_GUARD of Association %d", assocId);
-    T5_ShutdownGuardTimer = new cMessage(timerName);
+    T5_ShutdownGuardTimer = new WheelTimer(timerName);
     snprintf(timerName, sizeof(timerName), "SACK_TIMER of Association %d", assocId);
-    SackTimer = new cMessage(timerName);
+    SackTimer = new WheelTimer(timerName);
 
     if (sctpMain->testTimeout > 0){
         StartTesting = new cMessage("StartTesting");
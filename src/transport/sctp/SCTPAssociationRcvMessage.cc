@@ -697,7 +697,7 @@ void SCTPAssociation::tsnWasReneged(SCTPDataVariables*       chunk,
     }
     chunk->hasBeenReneged = true;
     chunk->gapReports = 1;
-    if (!chunk->getLastDestinationPath()->T3_RtxTimer->isScheduled()) {
+    if (!chunk->getLastDestinationPath()->T3_RtxTimer->isPending()) {
         startTimer(chunk->getLastDestinationPath()->T3_RtxTimer,
                 chunk->getLastDestinationPath()->pathRto);
     }
@@ -723,8 +723,8 @@ SCTPEventCode SCTPAssociation::processSackArrived(SCTPSackChunk* sackChunk)
         SCTPPathVariables* myPath = piter->second;
         sctpEV3 << "Path " << myPath->remoteAddress << ":\t"
                 << "outstanding=" << path->outstandingBytes << "\t"
-                << "T3scheduled=" << path->T3_RtxTimer->getArrivalTime() << " "
-                << (path->T3_RtxTimer->isScheduled() ? "[ok]" : "[NOT SCHEDULED]") << "\t"
+                << "T3scheduled=" << path->T3_RtxTimer->getExpiryTime() << " "
+                << (path->T3_RtxTimer->isPending() ? "[ok]" : "[NOT SCHEDULED]") << "\t"
                 << endl;
     }
 
@@ -1522,16 +1522,16 @@ void SCTPAssociation::stopTimers()
     }
 }
 
-void SCTPAssociation::stopTimer(cMessage* timer)
+void SCTPAssociation::stopTimer(WheelTimer* timer)
 {
 
     ev << "stopTimer " << timer->getName() << endl;
-    if (timer->isScheduled()) {
+    if (timer->isPending()) {
         cancelEvent(timer);
     }
 }
 
-void SCTPAssociation::startTimer(cMessage* timer, const simtime_t& timeout)
+void SCTPAssociation::startTimer(WheelTimer* timer, const simtime_t& timeout)
 {
     sctpEV3 << "startTimer " << timer->getName() << " with timeout "
             << timeout << " to expire at " << simTime() + timeout << endl;
@@ -183,7 +183,7 @@ void SCTPAssociation::timeForSack(bool& sackOnly, bool& sackWithData)
     if (state->ackState >= sackFrequency) {
         sackOnly = sackWithData = true;  // SACK necessary, regardless of data available
     }
-    else if (SackTimer->isScheduled()) {
+    else if (SackTimer->isPending()) {
         sackOnly = false;
         sackWithData = true;      // Only send SACK when data is present.
     }
@@ -685,7 +685,7 @@ void SCTPAssociation::sendOnPath(SCTPPathVariables* pathId, bool firstPass)
                         /* new chunks would exceed MTU, so we send old packet and build a new one */
                         /* this implies that at least one data chunk is send here */
                         if (dataChunksAdded > 0) {
-                            if (!path->T3_RtxTimer->isScheduled()) {
+                            if (!path->T3_RtxTimer->isPending()) {
                                 // Start retransmission timer, if not scheduled before
                                 startTimer(path->T3_RtxTimer, path->pathRto);
                             }
@@ -864,7 +864,7 @@ void SCTPAssociation::scheduleSack()
     if (state->ackState <= sackFrequency - 1)
     {
         /* start a SACK timer if none is running, to expire 200 ms (or parameter) from now */
-        if (!SackTimer->isScheduled())
+        if (!SackTimer->isPending())
         {
             startTimer(SackTimer, sackPeriod);
         }
@@ -55,16 +55,20 @@ static std::ostream& operator<<(std::ostream& os, const TCPConnection& conn)
 }
 
 
-void TCP::initialize()
+TCP::TCP() : ephemeralPorts(EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END)
 {
-    lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
-    WATCH(lastEphemeralPort);
+}
 
+void TCP::initialize()
+{
+    WATCH(ephemeralPorts);
     WATCH_PTRMAP(tcpConnMap);
     WATCH_PTRMAP(tcpAppConnMap);
 
     recordStatistics = par("recordStats");
 
+    timerWheel.init(this, par("timerGranularity"));
+
     cModule *netw = simulation.getSystemModule();
     testing = netw->hasPar("testing") && netw->par("testing").boolValue();
     logverbose = !testing && netw->hasPar("logverbose") && netw->par("logverbose").boolValue();
@@ -82,7 +86,19 @@ TCP::~TCP()
 
 void TCP::handleMessage(cMessage *msg)
 {
-    if (msg->isSelfMessage())
+    if (timerWheel.isTickMessage(msg))
+    {
+        WheelTimer *timer;
+        while ((timer = timerWheel.popExpired()) != NULL)
+        {
+            TCPConnection *conn = (TCPConnection *) timer->getContextPointer();
+            bool ret = conn->processTimer(timer);
+            if (!ret)
+                removeConnection(conn);
+        }
+        timerWheel.rearm();
+    }
+    else if (msg->isSelfMessage())
     {
         TCPConnection *conn = (TCPConnection *) msg->getContextPointer();
         bool ret = conn->processTimer(msg);
@@ -285,21 +301,10 @@ TCPConnection *TCP::findConnForApp(int appGateIndex, int connId)
 ushort TCP::getEphemeralPort()
 {
     // start at the last allocated port number + 1, and search for an unused one
-    ushort searchUntil = lastEphemeralPort++;
-    if (lastEphemeralPort == EPHEMERAL_PORTRANGE_END) // wrap
-        lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
-
-    while (usedEphemeralPorts.find(lastEphemeralPort)!=usedEphemeralPorts.end())
-    {
-        if (lastEphemeralPort == searchUntil) // got back to starting point?
-            error("Ephemeral port range %d..%d exhausted, all ports occupied", EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END);
-        lastEphemeralPort++;
-        if (lastEphemeralPort == EPHEMERAL_PORTRANGE_END) // wrap
-            lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
-    }
-
-    // found a free one, return it
-    return lastEphemeralPort;
+    int port = ephemeralPorts.findFreePort();
+    if (port==-1)
+        error("Ephemeral port range %d..%d exhausted, all ports occupied", EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END);
+    return port;
 }
 
 void TCP::addSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress remoteAddr, int localPort, int remotePort)
@@ -328,8 +333,7 @@ void TCP::addSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress re
     tcpConnMap[key] = conn;
 
     // mark port as used
-    if (localPort>=EPHEMERAL_PORTRANGE_START && localPort<EPHEMERAL_PORTRANGE_END)
-        usedEphemeralPorts.insert(localPort);
+    ephemeralPorts.addUse(localPort);
 }
 
 void TCP::updateSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress remoteAddr, int localPort, int remotePort)
@@ -353,7 +357,7 @@ void TCP::updateSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress
     key.remotePort = conn->remotePort = remotePort;
     tcpConnMap[key] = conn;
 
-    // localPort doesn't change (see ASSERT above), so there's no need to update usedEphemeralPorts[].
+    // localPort doesn't change (see ASSERT above), so there's no need to update ephemeralPorts.
 }
 
 void TCP::addForkedConnection(TCPConnection *conn, TCPConnection *newConn, IPvXAddress localAddr, IPvXAddress remoteAddr, int localPort, int remotePort)
@@ -392,11 +396,8 @@ void TCP::removeConnection(TCPConnection *conn)
     key2.remotePort = conn->remotePort;
     tcpConnMap.erase(key2);
 
-    // IMPORTANT: usedEphemeralPorts.erase(conn->localPort) is NOT GOOD because it
-    // deletes ALL occurrences of the port from the multiset.
-    std::multiset<ushort>::iterator it = usedEphemeralPorts.find(conn->localPort);
-    if (it!=usedEphemeralPorts.end())
-        usedEphemeralPorts.erase(it);
+    // release one use of the port (forked connections share the port)
+    ephemeralPorts.removeUse(conn->localPort);
 
     delete conn;
 }
@@ -404,4 +405,10 @@ void TCP::removeConnection(TCPConnection *conn)
 void TCP::finish()
 {
     tcpEV << getFullPath() << ": finishing with " << tcpConnMap.size() << " connections open.\n";
+
+    if (recordStatistics)
+    {
+        recordScalar("timers scheduled", timerWheel.getNumTimersScheduled());
+        recordScalar("timer events", timerWheel.getNumTickEvents());
+    }
 }
@@ -22,6 +22,8 @@
 #include <set>
 #include <omnetpp.h>
 #include "IPvXAddress.h"
+#include "TimerWheel.h"
+#include "PortAllocator.h"
 
 
 class TCPConnection;
@@ -137,8 +139,10 @@ class INET_API TCP : public cSimpleModule
     TcpAppConnMap tcpAppConnMap;
     TcpConnMap tcpConnMap;
 
-    ushort lastEphemeralPort;
-    std::multiset<ushort> usedEphemeralPorts;
+    PortAllocator ephemeralPorts;
+
+    // connection timers are multiplexed onto a single self-message
+    TimerWheel timerWheel;
 
   protected:
     /** Factory method; may be overriden for customizing TCP */
@@ -158,7 +162,7 @@ class INET_API TCP : public cSimpleModule
     bool recordStatistics;  // output vectors on/off
 
   public:
-    TCP() {}
+    TCP();
     virtual ~TCP();
 
   protected:
@@ -189,6 +193,11 @@ class INET_API TCP : public cSimpleModule
      * To be called from TCPConnection: reserves an ephemeral port for the connection.
      */
     virtual ushort getEphemeralPort();
+
+    /**
+     * Returns the timing wheel that drives the connection timers.
+     */
+    TimerWheel& getTimerWheel() {return timerWheel;}
 };
 
 #endif
@@ -338,10 +338,10 @@ class INET_API TCPConnection
     TCPAlgorithm *tcpAlgorithm;
 
     // timers
-    cMessage *the2MSLTimer;
-    cMessage *connEstabTimer;
-    cMessage *finWait2Timer;
-    cMessage *synRexmitTimer; // for retransmitting SYN and SYN+ACK
+    WheelTimer *the2MSLTimer;
+    WheelTimer *connEstabTimer;
+    WheelTimer *finWait2Timer;
+    WheelTimer *synRexmitTimer; // for retransmitting SYN and SYN+ACK
 
     // statistics
     cOutVector *sndWndVector;   // snd_wnd
@@ -510,10 +510,17 @@ class INET_API TCPConnection
     void scheduleTimeout(cMessage *msg, simtime_t timeout)
         {tcpMain->scheduleAt(simTime()+timeout, msg);}
 
+    /** Utility: start a timer in the timing wheel of the TCP module */
+    void scheduleTimeout(WheelTimer *timer, simtime_t timeout)
+        {tcpMain->getTimerWheel().scheduleAt(simTime()+timeout, timer);}
+
   protected:
     /** Utility: cancel a timer */
     cMessage *cancelEvent(cMessage *msg) {return tcpMain->cancelEvent(msg);}
 
+    /** Utility: cancel a timer in the timing wheel of the TCP module */
+    WheelTimer *cancelEvent(WheelTimer *timer) {return tcpMain->getTimerWheel().cancel(timer);}
+
     /** Utility: send IP packet */
     static void sendToIP(TCPSegment *tcpseg, IPvXAddress src, IPvXAddress dest);
 
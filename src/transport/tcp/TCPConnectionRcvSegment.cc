@@ -823,7 +823,7 @@ TCPEventCode TCPConnection::processSegmentInListen(TCPSegment *tcpseg, IPvXAddre
         state->ack_now = true;
         sendSynAck();
         startSynRexmitTimer();
-        if (!connEstabTimer->isScheduled())
+        if (!connEstabTimer->isPending())
             scheduleTimeout(connEstabTimer, TCP_TIMEOUT_CONN_ESTAB);
 
         //"
@@ -1303,7 +1303,7 @@ void TCPConnection::startSynRexmitTimer()
     state->syn_rexmit_count = 0;
     state->syn_rexmit_timeout = TCP_TIMEOUT_SYN_REXMIT;
 
-    if (synRexmitTimer->isScheduled())
+    if (synRexmitTimer->isPending())
         cancelEvent(synRexmitTimer);
     scheduleTimeout(synRexmitTimer, state->syn_rexmit_timeout);
 }
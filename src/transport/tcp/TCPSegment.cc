@@ -19,6 +19,7 @@
 #include "TCPSegment.h"
 
 Register_Class(TCPSegment);
+Register_Class(TCPPayloadCarrier);
 
 
 TCPSegment& TCPSegment::operator=(const TCPSegment& other)
@@ -134,6 +135,14 @@ cPacket *TCPSegment::removeFirstPayloadMessage(uint32& endSequenceNo)
     endSequenceNo = payloadList.front().endSequenceNo;
     payloadList.pop_front();
     drop(msg);
+
+    TCPPayloadCarrier *carrier = dynamic_cast<TCPPayloadCarrier *>(msg);
+    if (carrier)
+    {
+        // decapsulate() makes a private copy if the message is still shared
+        msg = carrier->decapsulate();
+        delete carrier;
+    }
     return msg;
 }
 
@@ -32,6 +32,25 @@ inline bool seqGreater(uint32 a, uint32 b) {return a!=b && a-b<(1UL<<31);}
 inline bool seqGE(uint32 a, uint32 b) {return a-b<(1UL<<31);}
 //@}
 
+/**
+ * Wrapper that lets the same application message travel in several TCP
+ * segments (original transmission, retransmissions, segment copies) without
+ * being duplicated each time. The message is encapsulated, and since
+ * encapsulated packets are reference counted, dup() on the carrier shares
+ * it instead of copying. TCPSegment::removeFirstPayloadMessage() unwraps
+ * carriers, so the receiver only gets a private copy when the message
+ * is actually delivered (copy-on-write).
+ *
+ * @see TCPMsgBasedSendQueue
+ */
+class INET_API TCPPayloadCarrier : public cPacket
+{
+  public:
+    TCPPayloadCarrier(const char *name=NULL) : cPacket(name) {}
+    TCPPayloadCarrier(const TCPPayloadCarrier& other) : cPacket(other) {}
+    TCPPayloadCarrier& operator=(const TCPPayloadCarrier& other) {cPacket::operator=(other); return *this;}
+    virtual TCPPayloadCarrier *dup() const {return new TCPPayloadCarrier(*this);}
+};
 
 /**
  * Represents a TCP segment. More info in the TCPSegment.msg file
@@ -75,6 +94,8 @@ class INET_API TCPSegment : public TCPSegment_Base
     /**
      * Removes and returns the first message object in this TCP segment.
      * It also returns the sequence number+1 of its last octet in outEndSequenceNo.
+     * If the message was added wrapped in a TCPPayloadCarrier, the carrier
+     * is deleted and the application message is returned.
      */
     virtual cPacket *removeFirstPayloadMessage(uint32& outEndSequenceNo);
 
@@ -35,14 +35,14 @@ DumbTCP::~DumbTCP()
 {
     // cancel and delete timers
     if (rexmitTimer)
-        delete conn->getTcpMain()->cancelEvent(rexmitTimer);
+        delete conn->getTcpMain()->getTimerWheel().cancel(rexmitTimer);
 }
 
 void DumbTCP::initialize()
 {
     TCPAlgorithm::initialize();
 
-    rexmitTimer = new cMessage("REXMIT");
+    rexmitTimer = new WheelTimer("REXMIT");
     rexmitTimer->setContextPointer(conn);
 }
 
@@ -59,7 +59,7 @@ void DumbTCP::established(bool active)
 
 void DumbTCP::connectionClosed()
 {
-    conn->getTcpMain()->cancelEvent(rexmitTimer);
+    conn->getTcpMain()->getTimerWheel().cancel(rexmitTimer);
 }
 
 void DumbTCP::processTimer(cMessage *timer, TCPEventCode& event)
@@ -115,8 +115,8 @@ void DumbTCP::ackSent()
 
 void DumbTCP::dataSent(uint32 fromseq)
 {
-    if (rexmitTimer->isScheduled())
-        conn->getTcpMain()->cancelEvent(rexmitTimer);
+    if (rexmitTimer->isPending())
+        conn->getTcpMain()->getTimerWheel().cancel(rexmitTimer);
     conn->scheduleTimeout(rexmitTimer, REXMIT_TIMEOUT);
 }
 
@@ -44,7 +44,7 @@ class INET_API DumbTCP : public TCPAlgorithm
   protected:
     DumbTCPStateVariables *&state; // alias to TCLAlgorithm's 'state'
 
-    cMessage *rexmitTimer;  // retransmission timer
+    WheelTimer *rexmitTimer;  // retransmission timer
 
   protected:
     /** Creates and returns a DumbTCPStateVariables object. */
@@ -104,10 +104,10 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
   protected:
     TCPBaseAlgStateVariables *&state; // alias to TCPAlgorithm's 'state'
 
-    cMessage *rexmitTimer;
-    cMessage *persistTimer;
-    cMessage *delayedAckTimer;
-    cMessage *keepAliveTimer;
+    WheelTimer *rexmitTimer;
+    WheelTimer *persistTimer;
+    WheelTimer *delayedAckTimer;
+    WheelTimer *keepAliveTimer;
 
     cOutVector *cwndVector;  // will record changes to snd_cwnd
     cOutVector *ssthreshVector; // will record changes to ssthresh
@@ -152,6 +152,9 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     /** Utility function */
     cMessage *cancelEvent(cMessage *msg) {return conn->getTcpMain()->cancelEvent(msg);}
 
+    /** Utility function */
+    WheelTimer *cancelEvent(WheelTimer *timer) {return conn->getTcpMain()->getTimerWheel().cancel(timer);}
+
   public:
     /**
      * Ctor.
@@ -16,6 +16,7 @@
 //
 
 
+#include <algorithm>
 #include "TCPMsgBasedSendQueue.h"
 
 Register_Class(TCPMsgBasedSendQueue);
@@ -23,6 +24,7 @@ Register_Class(TCPMsgBasedSendQueue);
 TCPMsgBasedSendQueue::TCPMsgBasedSendQueue() : TCPSendQueue()
 {
     begin = end = 0;
+    cursor = 0;
 }
 
 TCPMsgBasedSendQueue::~TCPMsgBasedSendQueue()
@@ -35,6 +37,7 @@ void TCPMsgBasedSendQueue::init(uint32 startSeq)
 {
     begin = startSeq;
     end = startSeq;
+    cursor = 0;
 }
 
 std::string TCPMsgBasedSendQueue::info() const
@@ -49,9 +52,13 @@ void TCPMsgBasedSendQueue::enqueueAppData(cPacket *msg)
     //tcpEV << "sendQ: " << info() << " enqueueAppData(bytes=" << msg->getByteLength() << ")\n";
     end += msg->getByteLength();
 
+    // wrap the message, so that segments can share it instead of dup()'ing it
+    TCPPayloadCarrier *carrier = new TCPPayloadCarrier(msg->getName());
+    carrier->encapsulate(msg);
+
     Payload payload;
     payload.endSequenceNo = end;
-    payload.msg = msg;
+    payload.msg = carrier;
     payloadQueue.push_back(payload);
 }
 
@@ -74,30 +81,52 @@ TCPSegment *TCPMsgBasedSendQueue::createSegmentWithBytes(uint32 fromSeq, ulong n
     tcpseg->setSequenceNo(fromSeq);
     tcpseg->setPayloadLength(numBytes);
 
-    // add payload messages whose endSequenceNo is between fromSeq and fromSeq+numBytes
-    PayloadQueue::iterator i = payloadQueue.begin();
-    while (i!=payloadQueue.end() && seqLE(i->endSequenceNo, fromSeq))
-        ++i;
+    // add payload messages whose endSequenceNo is between fromSeq and fromSeq+numBytes;
+    // the carriers' dup() shares the encapsulated message instead of copying it
+    unsigned int i = findPayloadAfter(fromSeq);
+    unsigned int n = payloadQueue.size();
     uint32 toSeq = fromSeq+numBytes;
-    const char *payloadName = NULL;
-    while (i!=payloadQueue.end() && seqLE(i->endSequenceNo, toSeq))
+    unsigned int first = i;
+    while (i<n && seqLE(payloadQueue[i].endSequenceNo, toSeq))
     {
-        if (!payloadName) payloadName = i->msg->getName();
-        tcpseg->addPayloadMessage(i->msg->dup(), i->endSequenceNo);
+        tcpseg->addPayloadMessage(payloadQueue[i].msg->dup(), payloadQueue[i].endSequenceNo);
         ++i;
     }
+    cursor = i;
 
-    // give segment a name
-    char msgname[80];
-    if (!payloadName)
-        sprintf(msgname, "tcpseg(l=%lu,%dmsg)", numBytes, tcpseg->getPayloadArraySize());
-    else
-        sprintf(msgname, "%.10s(l=%lu,%dmsg)", payloadName, numBytes, tcpseg->getPayloadArraySize());
-    tcpseg->setName(msgname);
+    // give segment a name (only needed for the animation)
+    if (ev.isGUI())
+    {
+        char msgname[80];
+        if (first==i)
+            sprintf(msgname, "tcpseg(l=%lu,%dmsg)", numBytes, tcpseg->getPayloadArraySize());
+        else
+            sprintf(msgname, "%.10s(l=%lu,%dmsg)", payloadQueue[first].msg->getName(),
+                    numBytes, tcpseg->getPayloadArraySize());
+        tcpseg->setName(msgname);
+    }
 
     return tcpseg;
 }
 
+bool TCPMsgBasedSendQueue::endsAfter(uint32 seq, const Payload& payload)
+{
+    return seqLess(seq, payload.endSequenceNo);
+}
+
+unsigned int TCPMsgBasedSendQueue::findPayloadAfter(uint32 seq)
+{
+    // try the cursor first: segments are usually created back to back
+    unsigned int n = payloadQueue.size();
+    if (cursor<=n
+        && (cursor==0 || seqLE(payloadQueue[cursor-1].endSequenceNo, seq))
+        && (cursor==n || seqLess(seq, payloadQueue[cursor].endSequenceNo)))
+        return cursor;
+
+    // binary search; end sequence numbers are increasing within the window
+    return std::upper_bound(payloadQueue.begin(), payloadQueue.end(), seq, endsAfter) - payloadQueue.begin();
+}
+
 void TCPMsgBasedSendQueue::discardUpTo(uint32 seqNum)
 {
     //tcpEV << "sendQ: " << info() << " discardUpTo(seq=" << seqNum << ")\n";
@@ -109,6 +138,8 @@ void TCPMsgBasedSendQueue::discardUpTo(uint32 seqNum)
     {
         delete payloadQueue.front().msg;
         payloadQueue.pop_front();
+        if (cursor>0)
+            cursor--;
     }
 }
 
@@ -18,12 +18,18 @@
 #ifndef __INET_TCPMESSAGESENDQUEUE_H
 #define __INET_TCPMESSAGESENDQUEUE_H
 
-#include <list>
+#include <deque>
 #include "TCPSendQueue.h"
 
 /**
  * Send queue that manages messages.
  *
+ * Messages are kept in a deque ordered by their end sequence numbers, so
+ * the payload messages of a segment are located by binary search, or in
+ * constant time via a cursor when segments are created back to back.
+ * Each message is stored wrapped in a TCPPayloadCarrier, and segments get
+ * shallow copies of the carriers instead of duplicates of the messages.
+ *
  * @see TCPMsgBasedRcvQueue
  */
 class INET_API TCPMsgBasedSendQueue : public TCPSendQueue
@@ -32,14 +38,27 @@ class INET_API TCPMsgBasedSendQueue : public TCPSendQueue
     struct Payload
     {
         unsigned int endSequenceNo;
-        cPacket *msg;
+        TCPPayloadCarrier *msg;
     };
-    typedef std::list<Payload> PayloadQueue;
+    typedef std::deque<Payload> PayloadQueue;
     PayloadQueue payloadQueue;
 
     uint32 begin;  // 1st sequence number stored
     uint32 end;    // last sequence number stored +1
 
+    // index of the first payload not included in the last created segment;
+    // consecutive createSegmentWithBytes() calls usually start right there
+    unsigned int cursor;
+
+  protected:
+    static bool endsAfter(uint32 seq, const Payload& payload);
+
+    /**
+     * Returns the index of the first payload whose endSequenceNo is
+     * greater than seq, or payloadQueue.size() if there is none.
+     */
+    virtual unsigned int findPayloadAfter(uint32 seq);
+
   public:
     /**
      * Ctor
@@ -24,6 +24,7 @@
 
 #include <omnetpp.h>
 #include <string.h>
+#include <algorithm>
 #include "UDPPacket.h"
 #include "UDP.h"
 #include "IPControlInfo.h"
@@ -63,15 +64,96 @@ static std::ostream & operator<<(std::ostream & os, const UDP::SockDesc& sd)
     return os;
 }
 
-static std::ostream & operator<<(std::ostream & os, const UDP::SockDescList& list)
+static std::ostream & operator<<(std::ostream & os, const UDP::SocketsByPortTable& table)
 {
-    for (UDP::SockDescList::const_iterator i=list.begin(); i!=list.end(); ++i)
-        os << "sockId=" << (*i)->sockId << " ";
+    // like the WATCH_MAP of the former port map, on one line: "port: sockIds"
+    for (int port = table.findNextPort(0); port!=-1; port = table.findNextPort(port+1))
+    {
+        os << port << ":";
+        const UDP::SockDescList& list = table.find(port)->sockets;
+        for (UDP::SockDescList::const_iterator i=list.begin(); i!=list.end(); ++i)
+            os << " sockId=" << (*i)->sockId;
+        os << "; ";
+    }
     return os;
 }
 
 //--------
 
+UDP::SocketsByPortTable::SocketsByPortTable()
+{
+    for (int i=0; i<NUM_PAGES; i++)
+        pages[i] = NULL;
+}
+
+UDP::SocketsByPortTable::~SocketsByPortTable()
+{
+    for (int i=0; i<NUM_PAGES; i++)
+    {
+        if (pages[i])
+        {
+            for (int j=0; j<PAGE_SIZE; j++)
+                delete pages[i][j];
+            delete [] pages[i];
+        }
+    }
+}
+
+UDP::PortSockets& UDP::SocketsByPortTable::getOrCreate(ushort port)
+{
+    PortSockets **&page = pages[port >> PAGE_BITS];
+    if (!page)
+    {
+        page = new PortSockets *[PAGE_SIZE];
+        for (int j=0; j<PAGE_SIZE; j++)
+            page[j] = NULL;
+    }
+    PortSockets *&entry = page[port & (PAGE_SIZE-1)];
+    if (!entry)
+        entry = new PortSockets();
+    return *entry;
+}
+
+int UDP::SocketsByPortTable::findNextPort(int port) const
+{
+    for (; port<65536; port++)
+    {
+        PortSockets **page = pages[port >> PAGE_BITS];
+        if (!page)
+            port |= PAGE_SIZE-1;  // skip the whole page
+        else if (page[port & (PAGE_SIZE-1)])
+            return port;
+    }
+    return -1;
+}
+
+void UDP::SocketsByPortTable::remove(ushort port)
+{
+    PortSockets **page = pages[port >> PAGE_BITS];
+    if (page)
+    {
+        delete page[port & (PAGE_SIZE-1)];
+        page[port & (PAGE_SIZE-1)] = NULL;
+    }
+}
+
+size_t UDP::ConnectedKeyHash::operator()(const ConnectedKey& key) const
+{
+    const uint32 *w = key.remoteAddr.words();
+    size_t h = inet_hash_combine(key.localPort, key.remotePort);
+    h = inet_hash_combine(h, w[0]);
+    if (key.remoteAddr.isIPv6())
+        for (int i=1; i<4; i++)
+            h = inet_hash_combine(h, w[i]);
+    return h;
+}
+
+//--------
+
+UDP::UDP() : ephemeralPorts(EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END)
+{
+}
+
 UDP::~UDP()
 {
     for (SocketsByIdMap::iterator i=socketsByIdMap.begin(); i!=socketsByIdMap.end(); ++i)
@@ -81,9 +163,9 @@ UDP::~UDP()
 void UDP::initialize()
 {
     WATCH_PTRMAP(socketsByIdMap);
-    WATCH_MAP(socketsByPortMap);
+    WATCH(socketsByPort);
+    WATCH(ephemeralPorts);
 
-    lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
     icmp = NULL;
     icmpv6 = NULL;
 
@@ -111,6 +193,7 @@ void UDP::bind(int gateIndex, UDPControlInfo *ctrl)
     sd->localPort = ctrl->getSrcPort();
     sd->remotePort = ctrl->getDestPort();
     sd->interfaceId = ctrl->getInterfaceId();
+    sd->isIndexed = false;
 
     if (sd->sockId==-1)
         error("sockId in BIND message not filled in");
@@ -128,9 +211,11 @@ void UDP::bind(int gateIndex, UDPControlInfo *ctrl)
     ASSERT(socketsByIdMap.find(sd->sockId)==socketsByIdMap.end());
     socketsByIdMap[sd->sockId] = sd;
 
-    // add to socketsByPortMap
-    SockDescList& list = socketsByPortMap[sd->localPort]; // create if doesn't exist
-    list.push_back(sd);
+    // add to socketsByPort
+    PortSockets& portSockets = socketsByPort.getOrCreate(sd->localPort);
+    portSockets.sockets.push_back(sd);
+    addToIndex(sd, portSockets);
+    ephemeralPorts.addUse(sd->localPort);
 }
 
 void UDP::connect(int sockId, IPvXAddress addr, int port)
@@ -144,8 +229,11 @@ void UDP::connect(int sockId, IPvXAddress addr, int port)
         opp_error("connect: invalid remote port number %d", port);
 
     SockDesc *sd = it->second;
+    PortSockets& portSockets = socketsByPort.getOrCreate(sd->localPort);
+    removeFromIndex(sd, portSockets);
     sd->remoteAddr = addr;
     sd->remotePort = port;
+    addToIndex(sd, portSockets);
 
     sd->onlyLocalPortIsSet = false;
 
@@ -163,34 +251,66 @@ void UDP::unbind(int sockId)
 
     EV << "Unbinding socket: " << *sd << "\n";
 
-    // remove from socketsByPortMap
-    SockDescList& list = socketsByPortMap[sd->localPort];
+    // remove from socketsByPort
+    PortSockets& portSockets = socketsByPort.getOrCreate(sd->localPort);
+    removeFromIndex(sd, portSockets);
+    SockDescList& list = portSockets.sockets;
     for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
         if (*it == sd)
             {list.erase(it); break;}
     if (list.empty())
-        socketsByPortMap.erase(sd->localPort);
+        socketsByPort.remove(sd->localPort);
+    ephemeralPorts.removeUse(sd->localPort);
     delete sd;
 }
 
-ushort UDP::getEphemeralPort()
+void UDP::addToIndex(SockDesc *sd, PortSockets& portSockets)
 {
-    // start at the last allocated port number + 1, and search for an unused one
-    ushort searchUntil = lastEphemeralPort++;
-    if (lastEphemeralPort == EPHEMERAL_PORTRANGE_END) // wrap
-        lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
+    sd->isIndexed = sd->remotePort!=0 && !sd->remoteAddr.isUnspecified() && sd->interfaceId==-1;
+    if (sd->isIndexed)
+    {
+        ConnectedKey key;
+        key.localPort = sd->localPort;
+        key.remotePort = sd->remotePort;
+        key.remoteAddr = sd->remoteAddr;
+        connectedSockets.insert(std::make_pair(key, sd));
+    }
+    else
+    {
+        portSockets.wildcardSockets.push_back(sd);
+    }
+}
 
-    while (socketsByPortMap.find(lastEphemeralPort)!=socketsByPortMap.end())
+void UDP::removeFromIndex(SockDesc *sd, PortSockets& portSockets)
+{
+    if (sd->isIndexed)
+    {
+        ConnectedKey key;
+        key.localPort = sd->localPort;
+        key.remotePort = sd->remotePort;
+        key.remoteAddr = sd->remoteAddr;
+        std::pair<ConnectedSocketMap::iterator,ConnectedSocketMap::iterator> range = connectedSockets.equal_range(key);
+        for (ConnectedSocketMap::iterator it=range.first; it!=range.second; ++it)
+            if (it->second == sd)
+                {connectedSockets.erase(it); break;}
+    }
+    else
     {
-        if (lastEphemeralPort == searchUntil) // got back to starting point?
-            error("Ephemeral port range %d..%d exhausted, all ports occupied", EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END);
-        lastEphemeralPort++;
-        if (lastEphemeralPort == EPHEMERAL_PORTRANGE_END) // wrap
-            lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
+        SockDescList& list = portSockets.wildcardSockets;
+        for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
+            if (*it == sd)
+                {list.erase(it); break;}
     }
+    sd->isIndexed = false;
+}
 
-    // found a free one, return it
-    return lastEphemeralPort;
+ushort UDP::getEphemeralPort()
+{
+    // start at the last allocated port number + 1, and search for an unused one
+    int port = ephemeralPorts.findFreePort();
+    if (port==-1)
+        error("Ephemeral port range %d..%d exhausted, all ports occupied", EPHEMERAL_PORTRANGE_START, EPHEMERAL_PORTRANGE_END);
+    return port;
 }
 
 void UDP::handleMessage(cMessage *msg)
@@ -363,13 +483,13 @@ void UDP::processICMPError(cPacket *msg)
        << remoteAddr << ":" << remotePort << "\n";
 
     // identify socket and report error to it
-    SocketsByPortMap::iterator it = socketsByPortMap.find(localPort);
-    if (it==socketsByPortMap.end())
+    PortSockets *portSockets = socketsByPort.find(localPort);
+    if (!portSockets)
     {
         EV << "No socket on that local port, ignoring ICMP error\n";
         return;
     }
-    SockDescList& list = it->second;
+    SockDescList& list = portSockets->sockets;
     SockDesc *srcSocket = NULL;
     for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
     {
@@ -421,51 +541,24 @@ void UDP::processUDPPacket(UDPPacket *udpPacket)
     cPolymorphic *ctrl = udpPacket->removeControlInfo();
 
     // send back ICMP error if no socket is bound to that port
-    SocketsByPortMap::iterator it = socketsByPortMap.find(destPort);
-    if (it==socketsByPortMap.end())
+    PortSockets *portSockets = socketsByPort.find(destPort);
+    if (!portSockets)
     {
         EV << "No socket registered on port " << destPort << "\n";
         processUndeliverablePacket(udpPacket, ctrl);
         return;
     }
-    SockDescList& list = it->second;
-
-    int matches = 0;
 
-    // deliver a copy of the packet to each matching socket
-    cPacket *payload = udpPacket->getEncapsulatedPacket();
+    IPvXAddress srcAddr;
     if (dynamic_cast<IPControlInfo *>(ctrl)!=NULL)
-    {
-        IPControlInfo *ctrl4 = (IPControlInfo *)ctrl;
-        for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
-        {
-            SockDesc *sd = *it;
-            if (sd->onlyLocalPortIsSet || matchesSocket(sd, udpPacket, ctrl4))
-            {
-                EV << "Socket sockId=" << sd->sockId << " matches, sending up a copy.\n";
-                sendUp((cPacket*)payload->dup(), udpPacket, ctrl4, sd);
-                matches++;
-            }
-        }
-    }
+        srcAddr = ((IPControlInfo *)ctrl)->getSrcAddr();
     else if (dynamic_cast<IPv6ControlInfo *>(ctrl)!=NULL)
-    {
-        IPv6ControlInfo *ctrl6 = (IPv6ControlInfo *)ctrl;
-        for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
-        {
-            SockDesc *sd = *it;
-            if (sd->onlyLocalPortIsSet || matchesSocket(sd, udpPacket, ctrl6))
-            {
-                EV << "Socket sockId=" << sd->sockId << " matches, sending up a copy.\n";
-                sendUp((cPacket*)payload->dup(), udpPacket, ctrl6, sd);
-                matches++;
-            }
-        }
-    }
+        srcAddr = ((IPv6ControlInfo *)ctrl)->getSrcAddr();
     else
-    {
         error("(%s)%s arrived from lower layer without control info", udpPacket->getClassName(), udpPacket->getName());
-    }
+
+    findMatchingSockets(*portSockets, udpPacket, srcAddr, ctrl);
+    int matches = matchingSockets.size();
 
     // send back ICMP error if there is no matching socket
     if (matches==0)
@@ -475,10 +568,83 @@ void UDP::processUDPPacket(UDPPacket *udpPacket)
         return;
     }
 
+    // Deliver the payload to each matching socket, in bind order. The last
+    // one gets the original payload and the others a dup() of it, which
+    // saves one copy per packet. Each receiver gets its own payload object;
+    // only a packet encapsulated in the payload (if there is one) is shared
+    // between the copies by OMNeT++'s reference counting, until a receiver
+    // decapsulates it.
+    cPacket *payload = udpPacket->decapsulate();
+    for (int i=0; i<matches; i++)
+    {
+        SockDesc *sd = matchingSockets[i];
+        cPacket *copy = i==matches-1 ? payload : payload->dup();
+        EV << "Socket sockId=" << sd->sockId << " matches, sending up the packet.\n";
+        if (dynamic_cast<IPControlInfo *>(ctrl)!=NULL)
+            sendUp(copy, udpPacket, (IPControlInfo *)ctrl, sd);
+        else
+            sendUp(copy, udpPacket, (IPv6ControlInfo *)ctrl, sd);
+    }
+    matchingSockets.clear();
+
     delete udpPacket;
     delete ctrl;
 }
 
+void UDP::findMatchingSockets(PortSockets& portSockets, UDPPacket *udpPacket, const IPvXAddress& srcAddr, cPolymorphic *ctrl)
+{
+    matchingSockets.clear();
+
+    // connected sockets: exact match on the remote address and port,
+    // only the local address needs to be checked
+    if (!connectedSockets.empty())
+    {
+        ConnectedKey key;
+        key.localPort = udpPacket->getDestinationPort();
+        key.remotePort = udpPacket->getSourcePort();
+        key.remoteAddr = srcAddr;
+        std::pair<ConnectedSocketMap::iterator,ConnectedSocketMap::iterator> range = connectedSockets.equal_range(key);
+        for (ConnectedSocketMap::iterator it=range.first; it!=range.second; ++it)
+        {
+            SockDesc *sd = it->second;
+            bool matches = dynamic_cast<IPControlInfo *>(ctrl)!=NULL ?
+                matchesSocket(sd, udpPacket, (IPControlInfo *)ctrl) : matchesSocket(sd, udpPacket, (IPv6ControlInfo *)ctrl);
+            if (matches)
+                matchingSockets.push_back(sd);
+        }
+    }
+
+    // the rest of the sockets on the port are matched one by one
+    SockDescList& list = portSockets.wildcardSockets;
+    if (dynamic_cast<IPControlInfo *>(ctrl)!=NULL)
+    {
+        IPControlInfo *ctrl4 = (IPControlInfo *)ctrl;
+        for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
+            if ((*it)->onlyLocalPortIsSet || matchesSocket(*it, udpPacket, ctrl4))
+                matchingSockets.push_back(*it);
+    }
+    else
+    {
+        IPv6ControlInfo *ctrl6 = (IPv6ControlInfo *)ctrl;
+        for (SockDescList::iterator it=list.begin(); it!=list.end(); ++it)
+            if ((*it)->onlyLocalPortIsSet || matchesSocket(*it, udpPacket, ctrl6))
+                matchingSockets.push_back(*it);
+    }
+
+    // with several receivers, restore the bind order in which they were
+    // always served (the hash table returns connected sockets in no
+    // particular order); this is rare enough to just walk the port's list
+    if (matchingSockets.size() > 1)
+    {
+        std::vector<SockDesc *> found;
+        found.swap(matchingSockets);
+        SockDescList& allSockets = portSockets.sockets;
+        for (SockDescList::iterator it=allSockets.begin(); it!=allSockets.end(); ++it)
+            if (std::find(found.begin(), found.end(), *it) != found.end())
+                matchingSockets.push_back(*it);
+    }
+}
+
 
 void UDP::processMsgFromApp(cPacket *appData)
 {
@@ -27,7 +27,10 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include "UDPControlInfo_m.h"
+#include "PortAllocator.h"
+#include "INETHash.h"
 
 class IPControlInfo;
 class IPv6ControlInfo;
@@ -57,19 +60,85 @@ class INET_API UDP : public cSimpleModule
         ushort localPort;
         ushort remotePort;
         int interfaceId; // FIXME do real sockets allow filtering by input interface??
+        bool isIndexed;  // whether it is in connectedSockets (otherwise in wildcardSockets)
     };
 
     typedef std::list<SockDesc *> SockDescList;
     typedef std::map<int,SockDesc *> SocketsByIdMap;
-    typedef std::map<int,SockDescList> SocketsByPortMap;
+
+    /**
+     * Sockets bound to a local port.
+     */
+    struct PortSockets
+    {
+        SockDescList sockets;          // all of them, in bind order
+        SockDescList wildcardSockets;  // the ones not in connectedSockets, in bind order
+    };
+
+    /**
+     * Sockets by local port. This is a direct-indexed table, split into
+     * pages of 256 ports that only get allocated when a socket is bound
+     * to a port in them; so lookups are O(1), and hosts with a few sockets
+     * don't pay for 64K entries.
+     */
+    class SocketsByPortTable
+    {
+      protected:
+        enum {PAGE_BITS = 8, PAGE_SIZE = 1 << PAGE_BITS, NUM_PAGES = 65536 >> PAGE_BITS};
+        PortSockets **pages[NUM_PAGES];
+
+      public:
+        SocketsByPortTable();
+        ~SocketsByPortTable();
+
+        /** Returns the sockets bound to the port, or NULL if there is none */
+        PortSockets *find(ushort port) const
+        {
+            PortSockets **page = pages[port >> PAGE_BITS];
+            return page ? page[port & (PAGE_SIZE-1)] : NULL;
+        }
+
+        /** Returns the sockets of the port, creating the entry if needed */
+        PortSockets& getOrCreate(ushort port);
+
+        /** Returns the lowest port >= port that has sockets bound, or -1 */
+        int findNextPort(int port) const;
+
+        /** Removes the (empty) entry of the port */
+        void remove(ushort port);
+    };
+
+    /**
+     * Key for connected sockets, i.e. ones with remote address and port set
+     * and no interface filter. The local address is not part of the key
+     * (it is usually unspecified), it is checked after the lookup.
+     */
+    struct ConnectedKey
+    {
+        ushort localPort;
+        ushort remotePort;
+        IPvXAddress remoteAddr;
+
+        bool operator==(const ConnectedKey& other) const
+            {return localPort==other.localPort && remotePort==other.remotePort && remoteAddr==other.remoteAddr;}
+    };
+
+    struct ConnectedKeyHash
+    {
+        size_t operator()(const ConnectedKey& key) const;
+    };
+
+    typedef inet_hash::unordered_multimap<ConnectedKey,SockDesc *,ConnectedKeyHash> ConnectedSocketMap;
 
   protected:
     // sockets
     SocketsByIdMap socketsByIdMap;
-    SocketsByPortMap socketsByPortMap;
+    SocketsByPortTable socketsByPort;
+    ConnectedSocketMap connectedSockets;  // exact-match index of connected sockets
+    std::vector<SockDesc *> matchingSockets;  // temp buffer for processUDPPacket(), in bind order
 
     // other state vars
-    ushort lastEphemeralPort;
+    PortAllocator ephemeralPorts;
     ICMP *icmp;
     ICMPv6 *icmpv6;
 
@@ -95,6 +164,13 @@ class INET_API UDP : public cSimpleModule
     // ephemeral port
     virtual ushort getEphemeralPort();
 
+    // put socket into connectedSockets or into the wildcard list of its port
+    virtual void addToIndex(SockDesc *sd, PortSockets& portSockets);
+    virtual void removeFromIndex(SockDesc *sd, PortSockets& portSockets);
+
+    // collect the sockets that should receive the packet into matchingSockets
+    virtual void findMatchingSockets(PortSockets& portSockets, UDPPacket *udp, const IPvXAddress& srcAddr, cPolymorphic *ctrl);
+
     virtual bool matchesSocket(SockDesc *sd, UDPPacket *udp, IPControlInfo *ctrl);
     virtual bool matchesSocket(SockDesc *sd, UDPPacket *udp, IPv6ControlInfo *ctrl);
     virtual bool matchesSocket(SockDesc *sd, const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, ushort remotePort);
@@ -119,7 +195,7 @@ class INET_API UDP : public cSimpleModule
     virtual UDPPacket *createUDPPacket(const char *name);
 
   public:
-    UDP() {}
+    UDP();
     virtual ~UDP();
 
   protected:
@@ -35,8 +35,8 @@ void ChannelAccess::initialize(int stage)
     {
         cc = ChannelControl::get();
 
-        // register to get a notification when position changes
-        nb->subscribe(this, NF_HOSTPOSITION_UPDATED);
+        // no need to subscribe to NF_HOSTPOSITION_UPDATED: the position is
+        // queried from ChannelControl when needed
     }
     else if (stage == 2)
     {
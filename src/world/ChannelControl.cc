@@ -18,6 +18,13 @@
 #include "ChannelControl.h"
 #include "FWMath.h"
 #include <cassert>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// limits the size of the grid used by updateAllConnections()
+#define MAX_GRID_CELLS_PER_AXIS 256
 
 
 #define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev << "ChannelControl: "
@@ -41,6 +48,9 @@ std::ostream& operator<<(std::ostream& os, const ChannelControl::TransmissionLis
 
 ChannelControl::ChannelControl()
 {
+    numLazyHosts = 0;
+    numDeliveries = 0;
+    numSuppressedDeliveries = 0;
 }
 
 ChannelControl::~ChannelControl()
@@ -78,6 +88,17 @@ void ChannelControl::initialize()
     numChannels = par("numChannels");
     transmissions.resize(numChannels);
 
+    numThreads = par("numThreads");
+    if (numThreads < 0)
+        error("invalid numThreads parameter %d", numThreads);
+#ifdef _OPENMP
+    if (numThreads == 0)
+        numThreads = omp_get_num_procs();
+#else
+    numThreads = 1;
+#endif
+    minParallelReceptions = par("minParallelReceptions");
+
     lastOngoingTransmissionsUpdate = 0;
 
     maxInterferenceDistance = calcInterfDist();
@@ -89,6 +110,12 @@ void ChannelControl::initialize()
     updateDisplayString(getParentModule());
 }
 
+void ChannelControl::finish()
+{
+    recordScalar("frame deliveries", numDeliveries);
+    recordScalar("suppressed frame deliveries", numSuppressedDeliveries);
+}
+
 /**
  * Sets up background size by adding the following tags:
  * "p=0,0;b=$playgroundSizeX,$playgroundSizeY"
@@ -146,12 +173,20 @@ ChannelControl::HostRef ChannelControl::registerHost(cModule *host, const Coord&
         radioInGate = host->gate("radioIn"); // throws error if gate does not exist
 
     HostEntry he;
+    he.index = hostsByIndex.size();
     he.host = host;
     he.radioInGate = radioInGate;
     he.pos = initialPos;
+    he.trajectory = NULL;
+    he.posTime = simTime();
+    he.receptionFilter = NULL;
     he.isNeighborListValid = false;
     he.channel = 0;  // for now
     hosts.push_back(he);
+    hostsByIndex.push_back(&hosts.back());
+    positions.x.push_back(initialPos.x);
+    positions.y.push_back(initialPos.y);
+    positions.z.push_back(0);
     return &hosts.back(); // last element
 }
 
@@ -177,21 +212,46 @@ const ChannelControl::HostRefVector& ChannelControl::getNeighbors(HostRef h)
     return h->neighborList;
 }
 
+const ChannelControl::HostPositions& ChannelControl::getHostPositions()
+{
+    if (numLazyHosts > 0)
+    {
+        simtime_t now = simTime();
+        for (int i = 0; i < (int)hostsByIndex.size(); i++)
+        {
+            HostRef h = hostsByIndex[i];
+            if (h->trajectory && h->posTime != now)
+                evaluatePosition(h);
+        }
+    }
+    return positions;
+}
+
 void ChannelControl::updateConnections(HostRef h)
 {
-    Coord& hpos = h->pos;
+    // first check the distances in a tight loop over the position arrays
+    // (omitting the square root saves CPU), then update the neighbor sets
+    int n = hostsByIndex.size();
+    const double *xs = &positions.x[0];
+    const double *ys = &positions.y[0];
+    const double *zs = &positions.z[0];
+    double hx = xs[h->index], hy = ys[h->index], hz = zs[h->index];
     double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
-    for (HostList::iterator it = hosts.begin(); it != hosts.end(); ++it)
+    inRange.resize(n);
+    char *r = &inRange[0];
+    for (int i = 0; i < n; i++)
     {
-        HostEntry *hi = &(*it);
+        double dx = xs[i] - hx, dy = ys[i] - hy, dz = zs[i] - hz;
+        r[i] = dx*dx + dy*dy + dz*dz < maxDistSquared;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        HostEntry *hi = hostsByIndex[i];
         if (hi == h)
             continue;
 
-        // get the distance between the two hosts.
-        // (omitting the square root (calling sqrdist() instead of distance()) saves about 5% CPU)
-        bool inRange = hpos.sqrdist(hi->pos) < maxDistSquared;
-
-        if (inRange)
+        if (r[i])
         {
             // nodes within communication range: connect
             if (h->neighbors.insert(hi).second == true)
@@ -222,9 +282,110 @@ void ChannelControl::updateHostPosition(HostRef h, const Coord& pos)
 {
     Enter_Method_Silent();
     h->pos = pos;
+    h->posTime = simTime();
+    storePosition(h);
     updateConnections(h);
 }
 
+void ChannelControl::setHostTrajectory(HostRef h, ITrajectory *trajectory)
+{
+    Enter_Method_Silent();
+    if (h->trajectory && !trajectory)
+        numLazyHosts--;
+    else if (!h->trajectory && trajectory)
+        numLazyHosts++;
+    h->trajectory = trajectory;
+    h->posTime = simTime();
+}
+
+void ChannelControl::setHostReceptionFilter(HostRef h, IReceptionFilter *filter)
+{
+    Enter_Method_Silent();
+    h->receptionFilter = filter;
+}
+
+void ChannelControl::setHostPosition(HostRef h, const Coord& pos)
+{
+    Enter_Method_Silent();
+    h->pos = pos;
+    h->posTime = simTime();
+    storePosition(h);
+}
+
+void ChannelControl::updateAllConnections()
+{
+    Enter_Method_Silent();
+
+    // put the hosts into a grid whose cells are (at least) as large as the
+    // interference distance, so that the neighbors of a host can only be in
+    // its own cell and the 8 cells around it
+    double cellSize = maxInterferenceDistance;
+    int numCellsX = 1, numCellsY = 1;
+    if (cellSize > 0)
+    {
+        numCellsX = std::max(1, std::min(MAX_GRID_CELLS_PER_AXIS, (int)(playgroundSize.x / cellSize)));
+        numCellsY = std::max(1, std::min(MAX_GRID_CELLS_PER_AXIS, (int)(playgroundSize.y / cellSize)));
+    }
+    double cellSizeX = playgroundSize.x / numCellsX;
+    double cellSizeY = playgroundSize.y / numCellsY;
+
+    int numHosts = hostsByIndex.size();
+    const HostRefVector& hostRefs = hostsByIndex;
+    std::vector<int> hostCells(numHosts);
+    std::vector<int> cellStart(numCellsX * numCellsY + 1, 0);
+    for (int i = 0; i < numHosts; i++)
+    {
+        // hosts may be slightly outside the playground; a zero playground size means a single cell
+        int cx = cellSizeX > 0 ? std::max(0, std::min(numCellsX-1, (int)floor(positions.x[i] / cellSizeX))) : 0;
+        int cy = cellSizeY > 0 ? std::max(0, std::min(numCellsY-1, (int)floor(positions.y[i] / cellSizeY))) : 0;
+        hostCells[i] = cy * numCellsX + cx;
+        cellStart[hostCells[i] + 1]++;
+    }
+
+    // counting sort of the hosts by cell
+    for (int c = 0; c < numCellsX * numCellsY; c++)
+        cellStart[c+1] += cellStart[c];
+    std::vector<int> cellHosts(numHosts);
+    std::vector<int> next(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < numHosts; i++)
+        cellHosts[next[hostCells[i]]++] = i;
+
+    double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
+    std::vector<HostRef> candidates;
+    for (int i = 0; i < numHosts; i++)
+    {
+        HostRef h = hostRefs[i];
+        Coord3D hpos = positions.get(i);
+        int cx = hostCells[i] % numCellsX;
+        int cy = hostCells[i] / numCellsX;
+
+        candidates.clear();
+        for (int y = std::max(0, cy-1); y <= std::min(numCellsY-1, cy+1); y++)
+        {
+            for (int x = std::max(0, cx-1); x <= std::min(numCellsX-1, cx+1); x++)
+            {
+                int c = y * numCellsX + x;
+                for (int k = cellStart[c]; k < cellStart[c+1]; k++)
+                {
+                    int j = cellHosts[k];
+                    if (j != i && hpos.sqrdist(positions.get(j)) < maxDistSquared)
+                        candidates.push_back(hostRefs[j]);
+                }
+            }
+        }
+
+        // the distance is symmetric, so every host can replace its own set;
+        // only touch the set (and the cached vector) if it changed
+        std::sort(candidates.begin(), candidates.end());
+        if (candidates.size() != h->neighbors.size() || !std::equal(candidates.begin(), candidates.end(), h->neighbors.begin()))
+        {
+            h->neighbors.clear();
+            h->neighbors.insert(candidates.begin(), candidates.end());
+            h->isNeighborListValid = false;
+        }
+    }
+}
+
 void ChannelControl::updateHostChannel(HostRef h, const int channel)
 {
     Enter_Method_Silent();
@@ -238,7 +399,7 @@ const ChannelControl::TransmissionList& ChannelControl::getOngoingTransmissions(
     Enter_Method_Silent();
 
     checkChannel(channel);
-    purgeOngoingTransmissions();
+    purgeOngoingTransmissions(channel);
     return transmissions[channel];
 }
 
@@ -255,7 +416,8 @@ void ChannelControl::addOngoingTransmission(HostRef h, AirFrame *frame)
         return;
     }
 
-    // purge old transmissions from time to time
+    // purge old transmissions on this channel, and on all other channels from time to time
+    purgeOngoingTransmissions(frame->getChannelNumber());
     if (simTime() - lastOngoingTransmissionsUpdate > TRANSMISSION_PURGE_INTERVAL)
     {
         purgeOngoingTransmissions();
@@ -265,50 +427,117 @@ void ChannelControl::addOngoingTransmission(HostRef h, AirFrame *frame)
     // register ongoing transmission
     take(frame);
     frame->setTimestamp(); // store time of transmission start
-    transmissions[frame->getChannelNumber()].push_back(frame);
+    transmissions[frame->getChannelNumber()].insert(frame);
 }
 
 void ChannelControl::purgeOngoingTransmissions()
 {
     for (int i = 0; i < numChannels; i++)
+        purgeOngoingTransmissions(i);
+}
+
+void ChannelControl::purgeOngoingTransmissions(int channel)
+{
+    // the frames that ended the earliest are at the front; a frame is kept
+    // while it may still be arriving at a host within interference distance
+    TransmissionList& tl = transmissions[channel];
+    simtime_t now = simTime();
+    simtime_t maxPropagationDelay = maxInterferenceDistance / LIGHT_SPEED;
+    while (!tl.empty())
     {
-        for (TransmissionList::iterator it = transmissions[i].begin(); it != transmissions[i].end();)
-        {
-            TransmissionList::iterator curr = it;
-            AirFrame *frame = *it;
-            it++;
+        AirFrame *frame = *tl.begin();
+        if (frame->getTimestamp() + frame->getDuration() + maxPropagationDelay >= now)
+            break;
+        tl.erase(tl.begin());
+        delete frame;
+    }
+}
 
-            if (frame->getTimestamp() + frame->getDuration() + TRANSMISSION_PURGE_INTERVAL < simTime())
-            {
-                delete frame;
-                transmissions[i].erase(curr);
-            }
-        }
+void ChannelControl::sendToHosts(cSimpleModule *srcRadioMod, AirFrame *airFrame)
+{
+    int n = receptions.size();
+    if (numThreads > 1 && n >= minParallelReceptions)
+        calculateReceivedPowers(srcRadioMod, airFrame);
+    for (int i = 0; i < n; i++)
+        sendToHost(srcRadioMod, airFrame, receptions[i]);
+    receptions.clear();
+}
+
+void ChannelControl::calculateReceivedPowers(cSimpleModule *srcRadioMod, AirFrame *airFrame)
+{
+    // NOTE: this runs on several threads at once; the reception filters
+    // only read their own state here, and the results are handed over to
+    // them in sendToHost(), in this same event
+    int n = receptions.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(numThreads)
+#endif
+    for (int i = 0; i < n; i++)
+    {
+        Reception& r = receptions[i];
+        if (r.host->receptionFilter)
+            r.rcvdPower = r.host->receptionFilter->calculateReceivedPower(srcRadioMod, airFrame, r.host->pos);
+    }
+}
+
+void ChannelControl::sendToHost(cSimpleModule *srcRadioMod, AirFrame *airFrame, const Reception& reception)
+{
+    HostRef h = reception.host;
+    if (h->receptionFilter && !h->receptionFilter->isReceptionNeeded(srcRadioMod, airFrame, h->pos, reception.rcvdPower))
+    {
+        coreEV << "frame cannot affect host " << h->host->getFullPath() << ", not delivering it\n";
+        numSuppressedDeliveries++;
+        return;
     }
+
+    // account for propagation delay, based on distance in meters
+    // Over 300m, dt=1us=10 bit times @ 10Mbps
+    simtime_t delay = reception.distance / LIGHT_SPEED;
+    srcRadioMod->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), h->radioInGate);
+    numDeliveries++;
 }
 
 void ChannelControl::sendToChannel(cSimpleModule *srcRadioMod, HostRef srcHost, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
 
+    int channel = airFrame->getChannelNumber();
+    if (numLazyHosts > 0)
+    {
+        // the neighbor sets don't follow the hosts that move along their
+        // trajectories, so check the distance to every host at the current time
+        const HostPositions& p = getHostPositions();
+        Coord3D srcPos = p.get(srcHost->index);
+        double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
+        for (int i = 0; i < p.size(); i++)
+        {
+            HostRef h = hostsByIndex[i];
+            if (h == srcHost || h->channel != channel)
+                continue;
+            double sqrdist = srcPos.sqrdist(p.get(i));
+            if (sqrdist < maxDistSquared)
+                addReception(h, sqrt(sqrdist));
+        }
+        sendToHosts(srcRadioMod, airFrame);
+        addOngoingTransmission(srcHost, airFrame);
+        return;
+    }
+
     // loop through all hosts in range
     const HostRefVector& neighbors = getNeighbors(srcHost);
     int n = neighbors.size();
-    int channel = airFrame->getChannelNumber();
     for (int i=0; i<n; i++)
     {
         HostRef h = neighbors[i];
         if (h->channel == channel)
         {
             coreEV << "sending message to host listening on the same channel\n";
-            // account for propagation delay, based on distance in meters
-            // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = srcHost->pos.distance(h->pos) / LIGHT_SPEED;
-            srcRadioMod->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), h->radioInGate);
+            addReception(h, srcHost->pos.distance(h->pos));
         }
         else
             coreEV << "skipping host listening on a different channel\n";
     }
+    sendToHosts(srcRadioMod, airFrame);
 
     // register transmission
     addOngoingTransmission(srcHost, airFrame);
@@ -24,6 +24,9 @@
 #include <omnetpp.h>
 #include "AirFrame_m.h"
 #include "Coord.h"
+#include "Coord3D.h"
+#include "ITrajectory.h"
+#include "IReceptionFilter.h"
 
 #define LIGHT_SPEED 3.0E+8
 #define TRANSMISSION_PURGE_INTERVAL 1.0
@@ -44,7 +47,25 @@ class INET_API ChannelControl : public cSimpleModule
   public:
     typedef HostEntry *HostRef; // handle for ChannelControl's clients
     typedef std::vector<HostRef> HostRefVector;
-    typedef std::list<AirFrame*> TransmissionList;
+
+    /** @brief Orders AirFrames registered as ongoing transmissions by their end time */
+    struct TransmissionEndTimeLess {
+        bool operator()(const AirFrame *a, const AirFrame *b) const {
+            return a->getTimestamp() + a->getDuration() < b->getTimestamp() + b->getDuration();
+        }
+    };
+    typedef std::multiset<AirFrame*, TransmissionEndTimeLess> TransmissionList;
+
+    /**
+     * Positions of all hosts as a structure of arrays, indexed by
+     * getHostIndex(), so that distance loops run over contiguous memory.
+     * z is always 0 at the moment, as mobility models are 2D.
+     */
+    struct HostPositions {
+        std::vector<double> x, y, z;
+        int size() const {return x.size();}
+        Coord3D get(int i) const {return Coord3D(x[i], y[i], z[i]);}
+    };
 
   protected:
     /**
@@ -53,10 +74,14 @@ class INET_API ChannelControl : public cSimpleModule
      * interference distance).
      */
     struct HostEntry {
+        int index;  // in hostsByIndex and positions
         cModule *host;
         cGate *radioInGate;
         int channel;
         Coord pos; // cached
+        ITrajectory *trajectory;  // if not NULL, pos is evaluated from it on demand
+        simtime_t posTime;        // when pos was last updated
+        IReceptionFilter *receptionFilter;  // if not NULL, consulted before delivering frames
         std::set<HostRef> neighbors;  // cached neighbour list
 
         // we cache neighbors set in an std::vector, because std::set iteration is slow;
@@ -66,9 +91,16 @@ class INET_API ChannelControl : public cSimpleModule
     };
     HostList hosts;
 
+    /** @brief hosts and their positions by index; positions is updated together with HostEntry::pos */
+    HostRefVector hostsByIndex;
+    HostPositions positions;
+
+    /** @brief scratch buffer for updateConnections() */
+    std::vector<char> inRange;
+
     /** @brief keeps track of ongoing transmissions; this is needed when a host
      * switches to another channel (then it needs to know whether the target channel
-     * is empty or busy)
+     * is empty or busy). Each channel's transmissions are ordered by end time.
      */
     typedef std::vector<TransmissionList> ChannelTransmissionLists;
     ChannelTransmissionLists transmissions; // indexed by channel number (size=numChannels)
@@ -91,9 +123,38 @@ class INET_API ChannelControl : public cSimpleModule
     /** @brief the number of controlled channels */
     int numChannels;
 
+    /** @brief the number of hosts whose position is evaluated from their trajectory */
+    int numLazyHosts;
+
+    /** @brief statistics: frame deliveries scheduled and suppressed by the reception filters */
+    long numDeliveries;
+    long numSuppressedDeliveries;
+
+    /** @brief a host within interference distance of the current transmission */
+    struct Reception {
+        HostRef host;
+        double distance;
+        double rcvdPower;  // calculated in advance by the host's reception filter, or -1
+    };
+
+    /** @brief scratch buffer for sendToChannel() */
+    std::vector<Reception> receptions;
+
+    /** @brief number of threads that calculate the received powers of a transmission */
+    int numThreads;
+
+    /** @brief the received powers are only calculated in parallel for at least this many receivers */
+    int minParallelReceptions;
+
   protected:
     virtual void updateConnections(HostRef h);
 
+    /** @brief Copies the host's position into the positions arrays */
+    void storePosition(HostRef h) {positions.x[h->index] = h->pos.x; positions.y[h->index] = h->pos.y;}
+
+    /** @brief Updates the position of a host with a trajectory to the current time */
+    void evaluatePosition(HostRef h) {h->pos = h->trajectory->getPositionAt(simTime()); h->posTime = simTime(); storePosition(h);}
+
     /** @brief Calculate interference distance*/
     virtual double calcInterfDist();
 
@@ -103,9 +164,36 @@ class INET_API ChannelControl : public cSimpleModule
     /** @brief Reads init parameters and calculates a maximal interference distance*/
     virtual void initialize();
 
-    /** @brief Throws away expired transmissions. */
+    /** @brief Records the delivery statistics */
+    virtual void finish();
+
+    /** @brief Adds the host to receptions, with the received power not calculated yet */
+    void addReception(HostRef h, double distance) {
+        Reception r;
+        r.host = h;
+        r.distance = distance;
+        r.rcvdPower = -1;
+        receptions.push_back(r);
+    }
+
+    /** @brief Delivers a copy of the frame to the hosts in receptions */
+    void sendToHosts(cSimpleModule *srcRadioMod, AirFrame *airFrame);
+
+    /** @brief Asks the reception filters of the hosts in receptions for the received power, on numThreads threads */
+    void calculateReceivedPowers(cSimpleModule *srcRadioMod, AirFrame *airFrame);
+
+    /** @brief Delivers a copy of the frame to the host, unless its reception filter rejects it */
+    void sendToHost(cSimpleModule *srcRadioMod, AirFrame *airFrame, const Reception& reception);
+
+    /** @brief Throws away expired transmissions on all channels. */
     virtual void purgeOngoingTransmissions();
 
+    /**
+     * @brief Throws away the transmissions on the given channel that can no
+     * longer reach any host; as they are ordered by end time, this is O(expired)
+     */
+    virtual void purgeOngoingTransmissions(int channel);
+
     /** @brief Validate the channel identifier */
     virtual void checkChannel(const int channel);
 
@@ -128,23 +216,70 @@ class INET_API ChannelControl : public cSimpleModule
     /** @brief Returns the channel the given host listens on */
     int getHostChannel(HostRef h) const {return h->channel;}
 
+    /** @brief Returns the number of registered hosts */
+    int getNumHosts() const {return hostsByIndex.size();}
+
+    /** @brief Returns the host with the given index (0..getNumHosts()-1) */
+    HostRef getHostByIndex(int i) const {return hostsByIndex[i];}
+
+    /** @brief Returns the index of the host, also used in getHostPositions() */
+    int getHostIndex(HostRef h) const {return h->index;}
+
+    /** @brief Returns the current positions of all hosts */
+    const HostPositions& getHostPositions();
+
     /** @brief Returns the "handle" of a previously registered host */
     virtual HostRef lookupHost(cModule *host);
 
     /** @brief To be called when the host moved; updates proximity info */
     virtual void updateHostPosition(HostRef h, const Coord& pos);
 
+    /**
+     * @brief Stores the new position of the host without updating the proximity
+     * info; updateAllConnections() must be called before the next transmission.
+     */
+    virtual void setHostPosition(HostRef h, const Coord& pos);
+
+    /**
+     * @brief Updates the proximity info of all hosts in one pass; meant to be
+     * called after several hosts have been moved with setHostPosition().
+     */
+    virtual void updateAllConnections();
+
+    /**
+     * @brief Tells ChannelControl that the position of the host at any time
+     * can be obtained from the given trajectory, so the host does not need
+     * to call updateHostPosition() periodically, only when the trajectory
+     * changes. Pass NULL to revert to explicit position updates.
+     */
+    virtual void setHostTrajectory(HostRef h, ITrajectory *trajectory);
+
+    /**
+     * @brief Registers a filter that is asked before each frame is delivered
+     * to the host; deliveries it rejects are not scheduled at all. Pass NULL
+     * to deliver every frame within interference distance.
+     */
+    virtual void setHostReceptionFilter(HostRef h, IReceptionFilter *filter);
+
     /** @brief Called when host switches channel */
     virtual void updateHostChannel(HostRef h, const int channel);
 
-    /** @brief Provides a list of transmissions currently on the air */
+    /**
+     * @brief Provides the transmissions currently on the air (including the
+     * ones still propagating to hosts within interference distance), ordered
+     * by end time
+     */
     const TransmissionList& getOngoingTransmissions(const int channel);
 
     /** @brief Notifies the channel control with an ongoing transmission */
     virtual void addOngoingTransmission(HostRef h, AirFrame *frame);
 
     /** @brief Returns the host's position */
-    const Coord& getHostPosition(HostRef h)  {return h->pos;}
+    const Coord& getHostPosition(HostRef h)  {
+        if (h->trajectory && h->posTime != simTime())
+            evaluatePosition(h);
+        return h->pos;
+    }
 
     /** @brief Get the list of modules in range of the given host */
     const HostRefVector& getNeighbors(HostRef h);
@@ -0,0 +1,65 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IRECEPTIONFILTER_H
+#define IRECEPTIONFILTER_H
+
+#include <omnetpp.h>
+#include "AirFrame_m.h"
+#include "Coord.h"
+
+
+/**
+ * @brief Interface for radios that can tell in advance that a frame
+ * cannot have any effect on them, e.g. because it would arrive far below
+ * the noise floor.
+ *
+ * ChannelControl::sendToChannel() asks the filter registered with
+ * ChannelControl::setHostReceptionFilter() before delivering a frame to
+ * the host, and does not schedule the delivery if the answer is false.
+ * The methods are called in the context of the sending radio module.
+ *
+ * For transmissions with many receivers, ChannelControl may first call
+ * calculateReceivedPower() for all of them on several threads, and pass
+ * the results to isReceptionNeeded().
+ *
+ * @ingroup channelControl
+ */
+class INET_API IReceptionFilter
+{
+  public:
+    virtual ~IReceptionFilter() {}
+
+    /**
+     * @brief Returns the power (in mW) the frame sent by srcRadioMod
+     * arrives with at receiverPos, or -1 if it cannot be calculated in
+     * advance. This may run on several threads at once (for different
+     * receivers), so it must not change any state, nor log anything.
+     */
+    virtual double calculateReceivedPower(cModule *srcRadioMod, AirFrame *airFrame, const Coord& receiverPos) = 0;
+
+    /**
+     * @brief Returns false if the frame sent by srcRadioMod would not
+     * affect the receiver at receiverPos, so it need not be delivered.
+     * rcvdPower is the result of calculateReceivedPower(), or -1 if it
+     * was not called.
+     */
+    virtual bool isReceptionNeeded(cModule *srcRadioMod, AirFrame *airFrame, const Coord& receiverPos, double rcvdPower) = 0;
+};
+
+#endif
+
@@ -0,0 +1,50 @@
+//
+// Copyright (C) 2011 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ITRAJECTORY_H
+#define ITRAJECTORY_H
+
+#include <omnetpp.h>
+#include "Coord.h"
+
+
+/**
+ * @brief Interface for mobility models whose movement can be evaluated
+ * analytically at any point in time.
+ *
+ * Such models only need events at the boundaries of the segments of their
+ * trajectory (e.g. when a line segment ends), instead of every update
+ * interval. Hosts registered with ChannelControl::setHostTrajectory()
+ * have their positions computed on demand, when a frame is transmitted.
+ *
+ * @ingroup mobility
+ */
+class INET_API ITrajectory
+{
+  public:
+    virtual ~ITrajectory() {}
+
+    /**
+     * @brief Returns the position of the host at time t. t must not be
+     * earlier than the start of the current segment of the trajectory,
+     * and not later than the next event of the mobility model.
+     */
+    virtual Coord getPositionAt(simtime_t t) = 0;
+};
+
+#endif
+